@@ -36,17 +36,61 @@ Rules regarding realloc():
 To compile & run the test programs:
 ===================================
 $ rm ezi_str.exe
-$ gcc -Wall -o ezi_str d_string.c convescs.c strncpyxx.c sproc.c ezi_alloc.c -DEZI_TEST_APP ezi_str.c
+$ gcc -Wall -o ezi_str strncpyxx.c sproc.c ezi_alloc.c -DEZI_TEST_APP ezi_str.c
 $ ./ezi_str
 
 Or to check that a warning is generated for an over-initialised string:
-$ gcc -Wall -o ezi_str d_string.c convescs.c strncpyxx.c sproc.c ezi_alloc.c -DEZI_TEST_APP -DEZI_TEST_APP_OVERFLOW ezi_str.c
+$ gcc -Wall -o ezi_str strncpyxx.c sproc.c ezi_alloc.c -DEZI_TEST_APP -DEZI_TEST_APP_OVERFLOW ezi_str.c
 
 $ rm ezi_alloc.exe
 $ gcc -Wall -o ezi_alloc strncpyxx.c -DEZI_ALLOC_TEST_APP ezi_str.c
 $ ./ezi_alloc
 
+The self-checking test programs for the newer functions (each exits with its number of failures):
+$ gcc -Wall -o ezi_esc -DEZI_ESC_TEST_APP ezi_str.c -lm && ./ezi_esc
+$ gcc -Wall -o ezi_utf8 -DEZI_UTF8 -DEZI_UTF8_TEST_APP ezi_str.c -lm && ./ezi_utf8
+$ gcc -Wall -o ezi_case -DEZI_CASE_TEST_APP ezi_str.c -lm && ./ezi_case
+$ gcc -Wall -o ezi_pool -DEZI_THREADS -pthread -DEZI_POOL_TEST_APP ezi_str.c -lm && ./ezi_pool
+$ gcc -Wall -o ezi_sort -DEZI_THREADS -pthread -DEZI_SORT_TEST_APP ezi_str.c -lm && ./ezi_sort
+$ gcc -Wall -o ezi_num -DEZI_NUM_TEST_APP ezi_str.c -lm && ./ezi_num
+$ gcc -Wall -o ezi_strtab -DEZI_STRTAB_TEST_APP ezi_str.c -lm && ./ezi_strtab
+$ gcc -Wall -o ezi_log -DEZI_THREADS -pthread -DEZI_LOG_TEST_APP ezi_str.c -lm && ./ezi_log
+$ gcc -Wall -o ezi_replace -DEZI_REPLACE_TEST_APP ezi_str.c -lm && ./ezi_replace
+$ gcc -Wall -o ezi_ring -DEZI_THREADS -pthread -DEZI_RING_TEST_APP ezi_str.c -lm && ./ezi_ring
+$ gcc -Wall -o ezi_builder -DEZI_UTF8 -DEZI_BUILDER_TEST_APP ezi_str.c -lm && ./ezi_builder
 
+
+20261019 abb Brought ezi_dbg() & ezi_esc() back into this file as self-contained, capacity-safe
+             versions (no longer needing d_string_safe() or ConvertEscapeSequencesSafe()). Runs of
+             bytes which need no (un)escaping are located with SSE2 (or memchr()) and block-copied.
+             Added ezi_dbg_raw(), ezi_esc_raw(), ezi_dbg_len() & ezi_esc_len().
+20261019 abb Added the opt-in EZI_UTF8 build flag: truncation in ezi_cpy(), ezi_cat(), ezi_ch(),
+             ezi_trunc(), ezi_len(), ezi_vsnprintf() & ezi_realloc() backs off to the last
+             complete code point.  Added ezi_utf8_cut(), ezi_utf8_cplen(), ezi_utf8_count() and
+             the SIMD ezi_utf8_valid() (SSSE3 lookup-table validator, chosen at run time).
+20261019 abb Added ezi_upper(), ezi_lower(), ezi_translate() & ezi_tr(), with SSE2 case kernels and
+             an SSSE3 (pshufb) kernel for sparse byte maps.
+20261019 abb Added ezi_pool_xxx(), a small work-stealing executor (multi-threaded when built with
+             EZI_THREADS), and the ezi_batch_xxx() functions which use it.
+20261019 abb Added ezi_sort() & ezi_sort_unique(): multikey sort on cached 8-byte prefixes, with
+             a parallel sample-sort front end for large arrays.
+20261019 abb ezi_ltrim() now uses memmove(): memcpy() of overlapping regions is undefined.  Added
+             EZI_HEAD_T (O(1) left trim, compacted lazily) and the EZI_RING_T byte FIFO.
+20261019 abb Added the slow paths of the inline EZI_BUILDER_T functions in ezi_str.h.
+20261019 abb Added ezi_to_i64(), ezi_to_u64(), ezi_to_double(), ezi_hex_to_u32() & their _view
+             forms: length-bounded, locale-free, non-allocating, with 8-digits-at-a-time SWAR and
+             Eisel-Lemire conversion of doubles.
+20261019 abb Added EZI_STRTAB_T & ezi_strtab_xxx(): a packed, append-only string table with an
+             mmap()-able file format.
+20261019 abb Added ezi_strtab_compress(), ezi_strtab_eq() & ezi_strtab_prefix(): string tables
+             compressed with a trained table of up to 255 short symbols, FSST-style.
+20261019 abb Added EZI_LOG_T & ezi_log_xxx(): logging which records the arguments in a per-thread
+             ring and leaves formatting & writing to a background thread.
+20261019 abb Added ezi_replace(), ezi_replace_all() & their _raw variants, and EZI_GLOB_T &
+             ezi_glob_xxx().  ezi_overlay_raw() sets the length itself instead of calling
+             ezi_len(), and no longer over-copies when it runs out of room.
+20261019 abb Added ezi_batch_strtab().  Pool scratch space & work shares are now allocated
+             cache-line aligned, as documented.
 20220401 abb Combined ezi_snprintf.c and ezi_alloc.c into this file.
 20180208 abb Small changes following the review of 'max' and 'max_index'.
 20120827 alf Added ezi_overlay() & ezi_overlay_raw().
@@ -91,6 +135,21 @@ $ ./ezi_alloc
 #include <stddef.h>
 #include <stdio.h>         // for vsnprintf()
 #include <stdarg.h>        // for va_xxxxx()
+#include <ctype.h>         // for isdigit()
+#include <math.h>          // for HUGE_VAL, NAN & isinf()
+#if defined(__unix__) || defined(__APPLE__) || defined(EZI_POSIX)  // EZI_POSIX itself is set in ezi_str.h.
+#include <errno.h>         // for EINTR
+#include <fcntl.h>         // for open()
+#include <sys/mman.h>      // for mmap() of ezi_strtab_load()
+#include <sys/stat.h>      // for fstat()
+#include <time.h>          // for clock_gettime()
+#include <unistd.h>        // for close() & write()
+#endif
+#ifdef EZI_THREADS
+#include <pthread.h>       // for the ezi_pool_xxx() worker threads
+#include <sched.h>         // for sched_yield()
+#include <unistd.h>        // for sysconf()
+#endif
 
 #include "ezi_str.h"       // for strncpyn(), EZI_STR_T & prototypes, etc
 
@@ -101,6 +160,25 @@ $ ./ezi_alloc
 #define MIN(a,b) ((a)<(b)?(a):(b))
 #endif
 
+// Define EZI_NO_SIMD to build the plain C versions only (e.g. for a tiny target, or for testing).
+#if defined(__SSE2__) && !defined(EZI_NO_SIMD)
+#define EZI_SIMD_SSE2 1
+#include <emmintrin.h>     // for _mm_xxx() SSE2 intrinsics
+#endif
+
+// Kernels needing more than the compiler's baseline are built for their own target, and are only
+// called if the CPU reports the feature at run time.
+#if defined(EZI_SIMD_SSE2) && defined(__GNUC__)
+#define EZI_SIMD_DISPATCH 1
+#include <tmmintrin.h>     // for SSSE3 _mm_shuffle_epi8() & _mm_alignr_epi8()
+#define EZI_TARGET_SSSE3   __attribute__((target("ssse3")))
+#define EZI_CPU_SSSE3()    __builtin_cpu_supports("ssse3")
+#endif
+
+/* Define EZI_UTF8 to treat Ezi strings as UTF-8 text: any truncation backs off to the end of the
+last complete code point, so a truncated string is never left with a broken sequence at the end.
+Explicit byte counts (ezi_ltrim(), ezi_rtrim(), ezi_overlay()) are not adjusted. */
+
 /***************************************************************************************************************
  *
  *    @  @  @@@@  @     @@@   @@@@  @@@         @@@@  @  @  @  @   @@   @@@@@  @@@   @@   @  @   @@
@@ -113,7 +191,7 @@ $ ./ezi_alloc
  *
  ***************************************************************************************************************
 	These helper functions may also be used outside of EZI_STR type functions.
-	->	strncpysz(), strncpyn(), reversen()
+	->	strncpysz(), strncpyn(), reversen(), ezi_utf8_cplen(), ezi_utf8_cut()
 */
 
 char *strncpysz(char dest[], char from[], size_t sizeof_dest)
@@ -155,6 +233,34 @@ char *reversen(char string[], size_t size)
 	return string;
 }
 
+// Length of the UTF-8 code point started by byte 'lead': 1 to 4, or 0 if not a lead byte.
+size_t ezi_utf8_cplen(int lead)
+{
+	unsigned char c = (unsigned char)lead;
+
+	if ( c < 0x80 ) return 1ul;
+	if ( c < 0xc0 ) return 0ul;  // Continuation byte.
+	if ( c < 0xe0 ) return 2ul;
+	if ( c < 0xf0 ) return 3ul;
+	if ( c < 0xf8 ) return 4ul;
+	return 0ul;
+}
+
+// Returns 'len', or less if string[0..len) ends with an incomplete UTF-8 code point, in which case
+// the returned length cuts it off.  Only the last (up to) 4 bytes are looked at.
+size_t ezi_utf8_cut(char string[], size_t len)
+{
+	size_t k = len;
+
+	while ( k > 0ul && len - k < 3ul && ((unsigned char)string[k - 1] & 0xc0) == 0x80 )
+		k--;
+
+	if ( k > 0ul && ezi_utf8_cplen(string[k - 1]) > len - k + 1ul )
+		return k - 1ul;
+
+	return len;  // Complete, or not UTF-8 at all: leave it alone.
+}
+
 /********************************************************************************************************************
  *
  *    @@@@  @@@@  @@@        @@   @@@@@  @@@         @@@@  @  @  @  @   @@   @@@@@  @@@   @@   @  @   @@
@@ -167,6 +273,27 @@ char *reversen(char string[], size_t size)
  *
  ********************************************************************************************************************/
 
+#ifdef EZI_UTF8
+// Backs a truncated string off to its last complete code point, but not below 'keep'.
+static void ezi_utf8_backoff(EZI_STR_T *to, size_t keep)
+{
+	to->len = MAX(keep, ezi_utf8_cut(to->str, to->len));
+	to->str[to->len] = '\0';
+}
+
+// Whether ezi_ch() may append byte 'ch' without splitting a code point: a lead byte needs room for
+// its whole sequence, and a continuation byte needs an incomplete code point to continue.  So the
+// tail of a code point whose lead byte didn't fit is dropped, and so is a stray continuation byte,
+// however much room is left: the two can't be told apart.
+static int ezi_utf8_ch_fits(EZI_STR_T *to, int ch)
+{
+	if ( ((unsigned char)ch & 0xc0) == 0x80 )
+		return ezi_utf8_cut(to->str, to->len) != to->len;
+
+	return ezi_utf8_cplen(ch) <= to->max - to->len;
+}
+#endif
+
 EZI_STR_T *ezi_cat(EZI_STR_T *to, EZI_STR_T *from)
 {
 	// strncpyn does the MEMORY_CONFIDENCE stuff.
@@ -175,8 +302,17 @@ EZI_STR_T *ezi_cat(EZI_STR_T *to, EZI_STR_T *from)
 
 #ifndef MEMORY_CONFIDENCE
 	if ( to != NULL )
+#endif
+	{
+#ifdef EZI_UTF8
+		size_t old_len = to->len;
 #endif
 		to->len = MIN(to->max, to->len + from->len);     // Assumes that 'from' is correctly set up.
+#ifdef EZI_UTF8
+		if ( old_len + from->len > to->max )
+			ezi_utf8_backoff(to, old_len);
+#endif
+	}
 
 	return to;
 }
@@ -184,6 +320,10 @@ EZI_STR_T *ezi_cat(EZI_STR_T *to, EZI_STR_T *from)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 EZI_STR_T *ezi_cat_raw(EZI_STR_T *to, char *from)
 {
+#ifdef EZI_UTF8
+	size_t old_len = to ? to->len : 0ul;
+#endif
+
 	// strncpyn does the MEMORY_CONFIDENCE stuff.
 	// 'safe' strncpy(), adds a trailing '\0' if original string is too long.
 	strncpyn(&to->str[to->len], from, to->max - to->len);
@@ -191,7 +331,13 @@ EZI_STR_T *ezi_cat_raw(EZI_STR_T *to, char *from)
 #ifndef MEMORY_CONFIDENCE
 	if ( to != NULL )
 #endif
+	{
 		ezi_len(to);
+#ifdef EZI_UTF8
+		if ( from != NULL && to->len == to->max && from[to->max - old_len] != '\0' )  // Truncated?
+			ezi_utf8_backoff(to, old_len);
+#endif
+	}
 
 	return to;
 }
@@ -208,6 +354,12 @@ EZI_STR_T *ezi_ch(EZI_STR_T *to, int ch_integer)
 	{
 		to->len = to->max;               // If too big, truncate the string.
 	}                                    // Remember, len is # of bytes, max is the maximum index
+#ifdef EZI_UTF8
+	else if ( !ezi_utf8_ch_fits(to, ch_integer) )
+	{
+		// Drop the byte: a code point which doesn't fit is dropped whole.
+	}
+#endif
 	else
 	{
 		to->str[to->len] = (char)ch_integer;
@@ -240,7 +392,13 @@ EZI_STR_T *ezi_cpy(EZI_STR_T *to, EZI_STR_T *from)
 #ifndef MEMORY_CONFIDENCE
 	if ( to != NULL )
 #endif
+	{
 		to->len = MIN(to->max, from->len);     // Assumes that 'from' is correctly set up.
+#ifdef EZI_UTF8
+		if ( from->len > to->max )
+			ezi_utf8_backoff(to, 0ul);
+#endif
+	}
 
 	return to;
 }
@@ -255,7 +413,13 @@ EZI_STR_T *ezi_cpy_raw(EZI_STR_T *to, char *from) // non-Ezi-string to Ezi-strin
 #ifndef MEMORY_CONFIDENCE
 	if ( to != NULL )
 #endif
+	{
 		ezi_len(to);
+#ifdef EZI_UTF8
+		if ( from != NULL && to->len == to->max && from[to->max] != '\0' )  // Truncated?
+			ezi_utf8_backoff(to, 0ul);
+#endif
+	}
 
 	return to;
 }
@@ -299,8 +463,15 @@ size_t ezi_len(EZI_STR_T *to)
 	to->len = strlen(to->str);
 	if ( to->len >= to->max )            // 20180208 was '>'
 	{
+#ifdef EZI_UTF8
+		int truncated = to->len > to->max;
+#endif
 		to->len = to->max;               // If too long, truncate the string.
 		to->str[to->max] = '\0';
+#ifdef EZI_UTF8
+		if ( truncated )
+			ezi_utf8_backoff(to, 0ul);
+#endif
 	}
 
 	return to->len;
@@ -323,9 +494,8 @@ EZI_STR_T *ezi_ltrim(EZI_STR_T *to, size_t left_trim)
 
 	if ( left_trim > 0ul )  // only do a trim if actually requested
 	{
-		// +1 includes trailing '\0'
-		memcpy(to->str, &to->str[left_trim], to->len + 1 - left_trim);
-//		memmove(to->str, &to->str[left_trim], to->len + 1 - left_trim); // Overlap-safe, but slower.
+		// +1 includes trailing '\0'.  The regions overlap, so memcpy() is not allowed.
+		memmove(to->str, &to->str[left_trim], to->len + 1 - left_trim);
 		to->len -= left_trim;        // Adjust the length.
 	}
 
@@ -366,6 +536,8 @@ EZI_STR_T *ezi_overlay(EZI_STR_T *to, size_t index, EZI_STR_T* from)
 
 EZI_STR_T *ezi_overlay_raw(EZI_STR_T *to, size_t index, char *from, size_t from_len)
 {
+	size_t n;
+
 #ifndef MEMORY_CONFIDENCE
 	if ( to == NULL )
 		return NULL;
@@ -376,15 +548,17 @@ EZI_STR_T *ezi_overlay_raw(EZI_STR_T *to, size_t index, char *from, size_t from_
 		return to;
 	}
 
-	if ( (index + from_len) > to->max )  // only do a partial overlay of 'to's capacity exceeded.
+	n = MIN(from_len, to->max - index);  // only do a partial overlay if 'to's capacity exceeded.
+	memcpy(&to->str[index], from, n);
+	if ( index + n > to->len )
 	{
-		memcpy(&to->str[index], from, to->max - to->len);
+		to->len = index + n;
+		to->str[to->len] = '\0';
 	}
-	else
-	{
-		memcpy(&to->str[index], from, from_len);
-	}
-	ezi_len(to); // lazy way out
+#ifdef EZI_UTF8
+	if ( n < from_len )
+		ezi_utf8_backoff(to, index);
+#endif
 
 	return to;
 }
@@ -400,6 +574,9 @@ EZI_STR_T *ezi_trunc(EZI_STR_T *to, size_t new_len)
 
 	if ( new_len < to->len )  // Only truncate string if new length is shorter than current length.
 	{
+#ifdef EZI_UTF8
+		new_len = ezi_utf8_cut(to->str, new_len);
+#endif
 		to->str[new_len] = '\0';  // Truncate the string.
 		to->len = new_len;        // Adjust the length.
 	}
@@ -436,329 +613,5904 @@ EZI_STR_T *ezi_reverse(EZI_STR_T *s)
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-// HIDDEN function which does the bulk of the allocation & initialisation of the new Ezi string.
-static EZI_STR_T *ezi_alloc_private(size_t mem_size, size_t capacity, char *initstr)
-{
-	EZI_STR_T *ptr  = NULL;
+/* ezi_dbg() renders arbitrary bytes as printable, C-escaped text, e.g. for logging a binary frame.
+Printable ASCII is copied unchanged, except '\\' and '"'.  \a \b \f \n \r \t \v get their usual
+letter, and everything else becomes a 3-digit octal escape, e.g. "\177", which is never ambiguous
+with a following digit.  An escape sequence which would not fit in 'to' is not started, so the
+output can stop a few bytes short of to->max.
 
-	if ( capacity > 0ul )
-	{
-		if ( (ptr = malloc(mem_size)) != NULL )
-		{
-			ptr->max = capacity;
-			ezi_cpy_raw(ptr, initstr);  // Copies string & adjusts 'len'.
-		}
-	}
-	return ptr;
-}
+ezi_esc() is the reverse: it converts C escape sequences (including \ooo and \xhh) back to bytes.
+Unknown sequences are left as-is.  The output can never be longer than the input, so 'to' and
+'from' may be the same Ezi string.  Note that "\000" does produce an embedded '\0'.
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/* Ezi, and safe, strdup-style call.  Obeys strdup rules.  This creates a full-sized Ezi-String
-copy of the original Ezi-String.  I.e., if the original capacity is 20 bytes, and 5 bytes are used,
-then the duplicate will be 20 bytes in capacity, with 5 bytes used.
+The ezi_xxx_len() functions return the full output length, regardless of any 'to' capacity.
 
-RETURN VALUE
-Upon successful completion with size not equal to 0, ezi_dup_full() returns a pointer to the
-allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
-passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
-indicate the error. */
+Long runs of bytes which need no work are found with SSE2 (or memchr()) and copied in one go. */
 
-EZI_STR_T *ezi_dup_full(EZI_STR_T *original)
+static const char ezi_esc_letters[] = "abfnrtv";
+static const char ezi_esc_ctrls[]   = "\a\b\f\n\r\t\v";
+
+// Number of output bytes ezi_dbg() needs for byte 'ch'.
+static size_t ezi_dbg_width(char ch)
 {
-	size_t    capacity = original->max;
-	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+	unsigned char c = (unsigned char)ch;
 
-	return ezi_alloc_private(mem_size, capacity, original->str);
+	if ( c == '\\' || c == '"' )
+		return 2ul;
+	if ( c >= 0x20 && c < 0x7f )
+		return 1ul;
+	if ( c != '\0' && strchr(ezi_esc_ctrls, c) != NULL )
+		return 2ul;
+	return 4ul;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/* Ezi, and safe, strdup-style call.  Obeys strdup rules.  This creates a part-sized Ezi-String
-copy of the original Ezi-String.  I.e., if the original capacity is 20 bytes, and 5 bytes are used,
-then the duplicate will be 5 bytes in capacity, with 5 bytes used.
-
-RETURN VALUE
-Upon successful completion with size not equal to 0, ezi_dup_part() returns a pointer to the
-allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
-passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
-indicate the error. */
-
-EZI_STR_T *ezi_dup_part(EZI_STR_T *original)
+// Number of bytes at the start of 'from' which ezi_dbg() copies unchanged.
+static size_t ezi_dbg_run(const char *from, size_t from_len)
 {
-	size_t    capacity = original->len;
-	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+	size_t i = 0ul;
 
-	return ezi_alloc_private(mem_size, capacity, original->str);
-}
+#ifdef EZI_SIMD_SSE2
+	const __m128i space = _mm_set1_epi8(0x20);  // Signed compare: also catches 0x80 to 0xff.
+	const __m128i del   = _mm_set1_epi8(0x7f);
+	const __m128i bslsh = _mm_set1_epi8('\\');
+	const __m128i quote = _mm_set1_epi8('"');
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/* The ezi_dup_raw() allocates space for an EZI_STR_T object whose size in bytes is specified by the
-length of the raw string, *and* *copies* the raw string.
+	for ( ; i + 16 <= from_len; i += 16 )
+	{
+		__m128i v    = _mm_loadu_si128((const __m128i *)&from[i]);
+		__m128i bad  = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi8(v, space), _mm_cmpeq_epi8(v, del)),
+		                            _mm_or_si128(_mm_cmpeq_epi8(v, bslsh), _mm_cmpeq_epi8(v, quote)));
+		int     bits = _mm_movemask_epi8(bad);
 
-See "Rules regarding malloc()" above.
+		if ( bits != 0 )
+			return i + (size_t)__builtin_ctz((unsigned)bits);
+	}
+#endif
 
-RETURN VALUE
-Upon successful completion with size not equal to 0, ezi_dup_raw() returns a pointer to the
-allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
-passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
-indicate the error. */
+	while ( i < from_len && ezi_dbg_width(from[i]) == 1ul )
+		i++;
 
-EZI_STR_T *ezi_dup_raw(char *initstr)
+	return i;
+}
+
+// Writes the escape sequence for 'ch' (which is NOT copied unchanged) to 'to': returns its length.
+static size_t ezi_dbg_escape(char *to, char ch)
 {
-	size_t    capacity = strlen(initstr);
-	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+	unsigned char c = (unsigned char)ch;
+	const char   *ctrl;
 
-	return ezi_alloc_private(mem_size, capacity, initstr);
+	to[0] = '\\';
+	if ( c == '\\' || c == '"' )
+	{
+		to[1] = (char)c;
+		return 2ul;
+	}
+	if ( c != '\0' && (ctrl = strchr(ezi_esc_ctrls, c)) != NULL )
+	{
+		to[1] = ezi_esc_letters[ctrl - ezi_esc_ctrls];
+		return 2ul;
+	}
+	to[1] = (char)('0' + ((c >> 6) & 7));
+	to[2] = (char)('0' + ((c >> 3) & 7));
+	to[3] = (char)('0' + ( c       & 7));
+	return 4ul;
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/* The ezi_calloc() (Ezi Clear Alloc) function allocates unused space for an EZI_STR_T object whose
-size in bytes is specified by size, *and* *clears" the string to "" and the length to 0.
+size_t ezi_dbg_len(EZI_STR_T *from)
+{
+	size_t i, len = 0ul;
 
-See "Rules regarding malloc()" above.
+#ifndef MEMORY_CONFIDENCE
+	if ( from == NULL )
+		return 0ul;
+#endif
 
-RETURN VALUE
-Upon successful completion with size not equal to 0, ezi_calloc() returns a pointer to the
-allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
-passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
-indicate the error. */
+	for ( i = 0ul; i < from->len; i++ )
+	{
+		size_t run = ezi_dbg_run(&from->str[i], from->len - i);
 
-EZI_STR_T *ezi_calloc(size_t capacity)
-{
-	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+		len += run;
+		i   += run;
+		if ( i < from->len )
+			len += ezi_dbg_width(from->str[i]);
+	}
+	return len;
+}
 
-	return ezi_alloc_private(mem_size, capacity, "");
+EZI_STR_T *ezi_dbg(EZI_STR_T *to, EZI_STR_T *from)
+{
+	return ezi_dbg_raw(to, from->str, from->len);
 }
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-/* The ezi_realloc() function changes the size of the EZI_STR_T object pointed to by ptr to the size
-specified by size. If changed to a smaller string, and the old string was bigger, the string is
-truncated and '\0'-terminated.
+EZI_STR_T *ezi_dbg_raw(EZI_STR_T *to, char *from, size_t from_len)
+{
+	size_t in = 0ul, out = 0ul;
 
-If ptr is a null pointer, ezi_realloc() is equivalent to ezi_calloc() for the specified size.
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL )
+		return NULL;
+	if ( from == NULL )
+		from_len = 0ul;
+#endif
 
-See "Rules regarding realloc()" above.
+	while ( in < from_len )
+	{
+		size_t run = MIN(ezi_dbg_run(&from[in], from_len - in), to->max - out);
 
-RETURN VALUE
-Upon successful completion with a size not equal to 0, ezi_realloc() returns a pointer to the
-(possibly moved) allocated space. If size is 0, either a null pointer or a unique pointer that can
-be successfully passed to free() should be returned. If there is not enough available memory,
-ezi_realloc() should return a null pointer and set errno to [ENOMEM]. */
+		memcpy(&to->str[out], &from[in], run);
+		out += run;
+		in  += run;
 
-EZI_STR_T *ezi_realloc(EZI_STR_T *old_ptr, size_t capacity)
-{
-	EZI_STR_T *new_ptr  = old_ptr;
-	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+		if ( in >= from_len || ezi_dbg_width(from[in]) > to->max - out )
+			break;  // Finished, or the next escape sequence doesn't fit.
 
-	if ( old_ptr == NULL )
-	{
-		new_ptr = ezi_calloc(capacity);
+		out += ezi_dbg_escape(&to->str[out], from[in]);
+		in++;
 	}
-	else if ( capacity == 0ul )
+
+	to->len = out;
+	to->str[out] = '\0';
+	return to;
+}
+
+// Decodes the escape sequence at 'from' (from[0] is '\\') to '*to': returns the input length used.
+static size_t ezi_esc_decode(const char *from, size_t from_len, char *to)
+{
+	const char *ctrl;
+	unsigned    value = 0u;
+	size_t      i     = 1ul;
+	int         digit;
+
+	if ( from_len < 2ul )
 	{
-		free(old_ptr);
-		new_ptr = NULL;
+		*to = '\\';  // A trailing lone '\\' is left as-is.
+		return 1ul;
 	}
-	else
+
+	switch ( from[1] )
 	{
-		if ( (new_ptr = realloc(old_ptr, mem_size)) != NULL )
+	case '\\': case '\'': case '"': case '?':
+		*to = from[1];
+		return 2ul;
+
+	case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7':
+		while ( i < from_len && i < 4ul && from[i] >= '0' && from[i] <= '7' )
+			value = value * 8u + (unsigned)(from[i++] - '0');
+		*to = (char)value;
+		return i;
+
+	case 'x':
+		for ( i = 2ul; i < from_len && i < 4ul; i++ )
 		{
-			new_ptr->max = capacity;       // can be bigger or smaller
-			if ( new_ptr->len > new_ptr->max )  // if smaller than the current string length, truncate the string.
-			{
-				new_ptr->len = new_ptr->max;
-				new_ptr->str[new_ptr->len] = '\0';
-			}
+			if      ( from[i] >= '0' && from[i] <= '9' ) digit = from[i] - '0';
+			else if ( from[i] >= 'a' && from[i] <= 'f' ) digit = from[i] - 'a' + 10;
+			else if ( from[i] >= 'A' && from[i] <= 'F' ) digit = from[i] - 'A' + 10;
+			else break;
+			value = value * 16u + (unsigned)digit;
 		}
-		else
-			new_ptr = NULL;
-	}
-	return new_ptr;
-}
+		if ( i > 2ul )
+		{
+			*to = (char)value;
+			return i;
+		}
+		break;  // "\x" without digits: unknown.
 
-//////////////////////////////////////////////////////////////////////////////////////////
-/*EZI_STR_T *ezi_EG_helper(EZI_STR_T *p, char *raw_str)
-{
-	if ( p == NULL )
-	{
-		p = ezi_dup_raw(raw_str);
+	default:
+		if ( from[1] != '\0' && (ctrl = strchr(ezi_esc_letters, from[1])) != NULL )
+		{
+			*to = ezi_esc_ctrls[ctrl - ezi_esc_letters];
+			return 2ul;
+		}
+		break;
 	}
 
-	return p;
-}*/
+	*to = '\\';  // Unknown sequence: keep the '\\', and the next character is copied as normal.
+	return 1ul;
+}
 
-//////////////////////////////////////////////////////////////////////////////////////////
-int ezi_snprintf ( EZI_STR_T *ezi, const char *fmt, ... )
+size_t ezi_esc_len(EZI_STR_T *from)
 {
-	va_list  args;
-	int      possible_overflow;
+	size_t      len = 0ul;
+	const char *p, *end;
+	char        dummy;
 
-	//printf("ezi_snprintf:len,max,str=\"%lu,%lu,%s\"\n", ezi->len, ezi->max, ezi->str); fflush(stdout);
+#ifndef MEMORY_CONFIDENCE
+	if ( from == NULL )
+		return 0ul;
+#endif
 
-	va_start ( args, fmt );
-	possible_overflow = ezi_vsnprintf ( ezi, fmt, args );
-	va_end ( args );
+	for ( p = from->str, end = from->str + from->len; p < end; len++ )
+	{
+		const char *bs = memchr(p, '\\', (size_t)(end - p));
 
-	//printf("ezi_snprintf:len,max,str=\"%lu,%lu,%s\"\n", ezi->len, ezi->max, ezi->str); fflush(stdout);
-	//printf("possible_overflow:=\"%ld\"\n", possible_overflow); fflush(stdout);
+		if ( bs == NULL )
+			return len + (size_t)(end - p);
+		len += (size_t)(bs - p);
+		p    = bs + ezi_esc_decode(bs, (size_t)(end - bs), &dummy);
+	}
+	return len;
+}
 
-	return possible_overflow;
+EZI_STR_T *ezi_esc(EZI_STR_T *to, EZI_STR_T *from)
+{
+	return ezi_esc_raw(to, from->str, from->len);
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-// Use this where the va_list pointer has already been set up.
-int ezi_vsnprintf ( EZI_STR_T *ezi, const char *fmt, va_list args )
+EZI_STR_T *ezi_esc_raw(EZI_STR_T *to, char *from, size_t from_len)
 {
-	int possible_overflow;
+	size_t in = 0ul, out = 0ul;
 
-	possible_overflow = vsnprintf ( ezi->str, ezi->max + 1, fmt, args );
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL )
+		return NULL;
+	if ( from == NULL )
+		from_len = 0ul;
+#endif
 
-	if ( possible_overflow < 0 || possible_overflow >= (int)ezi->max ) // If overflowed...
-	{
-		ezi_len ( ezi );               // ... recalculate current length
-	}
-	else
+	while ( in < from_len && out < to->max )
 	{
-		ezi->len = ( size_t ) possible_overflow;  // Not overflowed: length is OK.
+		const char *bs  = memchr(&from[in], '\\', from_len - in);
+		size_t      run = MIN(bs ? (size_t)(bs - &from[in]) : from_len - in, to->max - out);
+		char        ch;
+
+		memmove(&to->str[out], &from[in], run);  // 'to' may be 'from': out <= in always.
+		out += run;
+		in  += run;
+
+		if ( in >= from_len || out >= to->max )
+			break;
+
+		in += ezi_esc_decode(&from[in], from_len - in, &ch);
+		to->str[out++] = ch;
 	}
 
-	return possible_overflow;
+	to->len = out;
+	to->str[out] = '\0';
+	return to;
 }
 
-//////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////
-#ifdef EZI_ALLOC_TEST_APP
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* UTF-8 helpers.  These work on any Ezi string, whether or not EZI_UTF8 is defined.
 
-#include "alflb.h"
+ezi_utf8_valid() checks for well-formed UTF-8 (no overlongs, surrogates, or code points beyond
+U+10FFFF) and returns 1 if valid, 0 if not.  On CPUs with SSSE3 it uses the lookup-table method of
+Keiser & Lemire ("Validating UTF-8 In Less Than One Instruction Per Byte"), 16 bytes at a time, with
+all-ASCII blocks skipped after a single test.  Otherwise a plain C version is used which skips ASCII
+8 bytes at a time.
 
-void p(EZI_STR_T *ezi, char *text)
-{
-	printf("%p:%3u:%3u:%-20.20s %s\n", ezi, (uint32_t)(ezi ? ezi->max : 0), (uint32_t)(ezi ? ezi->len : 0), ezi ? ezi->str : "<null>", text);
-	fflush(stdout);
-}
+ezi_utf8_count() returns the number of code points, i.e. the number of non-continuation bytes. */
 
-int main(int argc, char *argv[])
+static int ezi_utf8_valid_c(const char *string, size_t len)
 {
-	EZI_STR_T *a;
-	EZI_STR_T *b;
-	EZI_STR_T *c;
-	EZI_STR_T *d;
-	EZI_STR_T *e;
-	a = ezi_calloc(10);              p(a, "a = ezi_calloc(10);"              );
-	ezi_cpy_raw(a, "testing");       p(a, "    ezi_cpy_raw(a, \"testing\");" );
-	b = ezi_dup_raw("hello world");  p(b, "b = ezi_dup_raw(\"hello world\");");
-	b = ezi_realloc(b, 500);         p(b, "b = ezi_realloc(b, 500);"         );
-	b = ezi_realloc(b, 11);          p(b, "b = ezi_realloc(b, 11);"          );
-	b = ezi_realloc(b, 3);           p(b, "b = ezi_realloc(b, 3);"           );
-	c = ezi_calloc(0);               p(c, "c = ezi_calloc(0);"               );
-	c = ezi_realloc(c, 30);          p(c, "c = ezi_realloc(c, 30);"          );
-	ezi_cpy_raw(c, "hello");         p(c, "    ezi_cpy_raw(c,\"hello\");"    );
-	c = ezi_realloc(c, 60);          p(c, "c = ezi_realloc(c, 60);"          );
-	c = ezi_realloc(c, 0);           p(c, "c = ezi_realloc(c, 0);"           );
-	d = ezi_dup_full(a);             p(d, "d = ezi_dup_full(a);"             );
-	e = ezi_dup_part(a);             p(e, "e = ezi_dup_part(a);"             );
+	const unsigned char *s = (const unsigned char *)string;
+	size_t               i = 0ul, need;
+	uint64_t             word;
+	unsigned char        c, lo, hi;
 
-	return 0;
+	while ( i < len )
+	{
+		if ( i + 8ul <= len )
+		{
+			memcpy(&word, &s[i], 8);
+			if ( (word & 0x8080808080808080ull) == 0ull )
+			{
+				i += 8ul;
+				continue;
+			}
+		}
+
+		c  = s[i];
+		lo = 0x80;
+		hi = 0xbf;
+		if      ( c < 0x80 ) { i++; continue; }
+		else if ( c < 0xc2 ) return 0;  // Continuation byte, or overlong 2-byte sequence.
+		else if ( c < 0xe0 ) need = 1ul;
+		else if ( c < 0xf0 ) { need = 2ul; if ( c == 0xe0 ) lo = 0xa0; if ( c == 0xed ) hi = 0x9f; }
+		else if ( c < 0xf5 ) { need = 3ul; if ( c == 0xf0 ) lo = 0x90; if ( c == 0xf4 ) hi = 0x8f; }
+		else return 0;
+
+		if ( len - i <= need || s[i + 1] < lo || s[i + 1] > hi )
+			return 0;
+		for ( i += 2ul, need--; need > 0ul; i++, need-- )
+		{
+			if ( (s[i] & 0xc0) != 0x80 )
+				return 0;
+		}
+	}
+	return 1;
 }
-#endif // EZI_ALLOC_TEST_APP
 
-//////////////////////////////////////////////////////////////////////////////////////////
-#ifdef TEST_APP_EZI_SNPRINTF
+#ifdef EZI_SIMD_DISPATCH
+// Error bits for the lookup tables.  Each table flags what a byte could be part of; an error is
+// where all three agree, except where a third or fourth byte is legitimately expected.
+#define U8_TOO_SHORT  (1 << 0)
+#define U8_TOO_LONG   (1 << 1)
+#define U8_OVERLONG_3 (1 << 2)
+#define U8_TOO_LARGE  (1 << 3)
+#define U8_SURROGATE  (1 << 4)
+#define U8_OVERLONG_2 (1 << 5)
+#define U8_TOO_LARGE_1000 (1 << 6)
+#define U8_OVERLONG_4 (1 << 6)
+#define U8_TWO_CONTS  (1 << 7)
+#define U8_CARRY      (U8_TOO_SHORT | U8_TOO_LONG | U8_TWO_CONTS)
 
-#include "alflb.h"
+EZI_TARGET_SSSE3
+static int ezi_utf8_valid_ssse3(const char *string, size_t len)
+{
+	const __m128i byte_1_high = _mm_setr_epi8(
+		U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG, U8_TOO_LONG,
+		(char)U8_TWO_CONTS, (char)U8_TWO_CONTS, (char)U8_TWO_CONTS, (char)U8_TWO_CONTS,
+		U8_TOO_SHORT | U8_OVERLONG_2,
+		U8_TOO_SHORT,
+		U8_TOO_SHORT | U8_OVERLONG_3 | U8_SURROGATE,
+		U8_TOO_SHORT | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_OVERLONG_4);
+	const __m128i byte_1_low = _mm_setr_epi8(
+		(char)(U8_CARRY | U8_OVERLONG_3 | U8_OVERLONG_2 | U8_OVERLONG_4),
+		(char)(U8_CARRY | U8_OVERLONG_2),
+		(char)U8_CARRY,
+		(char)U8_CARRY,
+		(char)(U8_CARRY | U8_TOO_LARGE),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000 | U8_SURROGATE),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000),
+		(char)(U8_CARRY | U8_TOO_LARGE | U8_TOO_LARGE_1000));
+	const __m128i byte_2_high = _mm_setr_epi8(
+		U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT,
+		(char)(U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE_1000 | U8_OVERLONG_4),
+		(char)(U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_OVERLONG_3 | U8_TOO_LARGE),
+		(char)(U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE  | U8_TOO_LARGE),
+		(char)(U8_TOO_LONG | U8_OVERLONG_2 | U8_TWO_CONTS | U8_SURROGATE  | U8_TOO_LARGE),
+		U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT, U8_TOO_SHORT);
+	// Anything above these in the last 3 bytes starts a sequence which runs into the next block.
+	const __m128i max_tail = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	                                       (char)(0xf0 - 1), (char)(0xe0 - 1), (char)(0xc0 - 1));
+	const __m128i nibble   = _mm_set1_epi8(0x0f);
+	__m128i       prev       = _mm_setzero_si128();
+	__m128i       incomplete = _mm_setzero_si128();
+	__m128i       error      = _mm_setzero_si128();
+	char          tail[16];
+	size_t        i;
 
-int main ( int argc, char *argv[] )
+	for ( i = 0ul; i < len; i += 16ul )
+	{
+		__m128i in;
+
+		if ( i + 16ul <= len )
+			in = _mm_loadu_si128((const __m128i *)&string[i]);
+		else
+		{
+			memset(tail, 0, sizeof(tail));  // Pad the last block with ASCII NULs.
+			memcpy(tail, &string[i], len - i);
+			in = _mm_loadu_si128((const __m128i *)tail);
+		}
+
+		if ( _mm_movemask_epi8(in) == 0 )
+		{
+			error = _mm_or_si128(error, incomplete);  // All ASCII: fine, unless the last block was cut short.
+		}
+		else
+		{
+			__m128i prev1 = _mm_alignr_epi8(in, prev, 15);
+			__m128i prev2 = _mm_alignr_epi8(in, prev, 14);
+			__m128i prev3 = _mm_alignr_epi8(in, prev, 13);
+			__m128i sc    = _mm_and_si128(
+			                  _mm_and_si128(
+			                    _mm_shuffle_epi8(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble)),
+			                    _mm_shuffle_epi8(byte_1_low , _mm_and_si128(prev1, nibble))),
+			                  _mm_shuffle_epi8(byte_2_high, _mm_and_si128(_mm_srli_epi16(in, 4), nibble)));
+			__m128i third  = _mm_subs_epu8(prev2, _mm_set1_epi8((char)(0xe0 - 0x80)));  // Only 111xxxxx go >= 0x80.
+			__m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8((char)(0xf0 - 0x80)));  // Only 1111xxxx go >= 0x80.
+			__m128i must23 = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8((char)0x80));
+
+			error      = _mm_or_si128(error, _mm_xor_si128(must23, sc));
+			incomplete = _mm_subs_epu8(in, max_tail);
+		}
+		prev = in;
+	}
+
+	error = _mm_or_si128(error, incomplete);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xffff;
+}
+#endif // EZI_SIMD_DISPATCH
+
+int ezi_utf8_valid_raw(char *string, size_t len)
 {
-	EZI_STR ( medium, 20, "" );
-	EZI_STR ( small , 10, "" );
+#ifndef MEMORY_CONFIDENCE
+	if ( string == NULL )
+		return len == 0ul;
+#endif
 
-	ezi_snprintf ( medium, "%s%d%s", "hello", 20, "world" );
-	printf ( "%2lu:%s\n", medium->len, medium->str );
+#ifdef EZI_SIMD_DISPATCH
+	if ( EZI_CPU_SSSE3() )
+		return ezi_utf8_valid_ssse3(string, len);
+#endif
+	return ezi_utf8_valid_c(string, len);
+}
 
-	ezi_snprintf ( small, "%s%d%s", "hello", 20, "world" );
-	printf ( "%2lu:%s\n", small->len, small->str );
+int ezi_utf8_valid(EZI_STR_T *buf)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( buf == NULL )
+		return 0;
+#endif
 
-	return 0;
+	return ezi_utf8_valid_raw(buf->str, buf->len);
+}
+
+size_t ezi_utf8_count_raw(char *string, size_t len)
+{
+	size_t count = 0ul, i = 0ul;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( string == NULL )
+		return 0ul;
+#endif
+
+#ifdef EZI_SIMD_SSE2
+	{
+		const __m128i last_cont = _mm_set1_epi8((char)0xbf);  // Signed: continuations are 0x80 to 0xbf.
+
+		for ( ; i + 16ul <= len; i += 16ul )
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *)&string[i]);
+
+			count += (size_t)__builtin_popcount((unsigned)_mm_movemask_epi8(_mm_cmpgt_epi8(v, last_cont)));
+		}
+	}
+#endif
+
+	for ( ; i < len; i++ )
+		count += ((unsigned char)string[i] & 0xc0) != 0x80;
+
+	return count;
+}
+
+size_t ezi_utf8_count(EZI_STR_T *buf)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( buf == NULL )
+		return 0ul;
+#endif
+
+	return ezi_utf8_count_raw(buf->str, buf->len);
 }
-#endif // TEST_APP_EZI_SNPRINTF
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-#ifdef EZI_TEST_APP
+/* In-place ASCII case conversion & byte translation over str[0..len).
 
-#include "alflb.h"
+ezi_upper() & ezi_lower() change 'a'-'z' / 'A'-'Z' only: bytes >= 0x80 are left alone, so UTF-8
+survives.  They use SSE2 range compares, 16 bytes at a time.
 
-int main(int argc, char *argv[])
+ezi_translate() replaces each byte b with map[b].  With SSSE3, each group of 16 map entries sharing
+a high nibble is a pshufb table, indexed by the low nibble.  Only the groups which actually change
+something are applied, so a sparse map, touching a few characters (e.g. ':' to '/'), costs 1 or 2
+lookups per 16 bytes.  Maps changing more than 4 of the 16 groups use the plain C loop instead: it
+is the faster of the two from about 5 groups on, and even a kernel blending all 16 groups without
+compares, 4 instructions each, takes about 1.4 times as long as the C loop's table load per byte.
+
+ezi_tr() is like the shell's tr: from_set[i] becomes to_set[i], and the last character of to_set
+is repeated if it is shorter.  Both sets may contain ranges, e.g. ezi_tr(s, "a-z", "A-Z"). */
+
+static EZI_STR_T *ezi_case(EZI_STR_T *to, char first, char last)
 {
-	int       jj;
-#define       P printf
-#define       TMAX 20
-	EZI_STR   (s1, TMAX,    "");
-	EZI_STR   (s2, TMAX,    ".123456789.12345678");
-	EZI_STR   (s3, TMAX,    ".123456789.123456789");
-	EZI_STR   (s4, TMAX + 1,  ".123456789.123456789.");
-	EZI_STR   (non, TMAX,    ".\177\37\377456789.123456789");
-	char      c1[] = ".123456789.12345678";
-	char      c2[] = ".123456789.123456789.12345678";
-#ifdef EZI_TEST_APP_OVERFLOW     // should give at least a warning (would prefer an error)
-	EZI_STR   (over  , TMAX,    ".123456789.123456789.123456789.123456789");
+	size_t i = 0ul;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL )
+		return NULL;
 #endif
-	EZI_STR_T *p1;
-	EZI_STR_T *p2;
 
-	ezi_cpy(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s2)"  , (uint)s1->len, s1->str);
-	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
-	ezi_cpy(s1, s4);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s4)"  , (uint)s1->len, s1->str);
-	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len(recalc)"   , (uint)s1->len, s1->str); // recalc length
-	s1->str[15] = '\0';
-	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len(recalc)"   , (uint)s1->len, s1->str); // recalc length
-	for ( jj = 0; jj < 6; jj++ )
+#ifdef EZI_SIMD_SSE2
 	{
-	ezi_ch(s1, 'A' + jj);	P("%24.24s=len=%2u \"%s\"\n", "ezi_ch"            , (uint)s1->len, s1->str);
+		const __m128i below = _mm_set1_epi8((char)(first - 1));  // Signed: bytes >= 0x80 never match.
+		const __m128i above = _mm_set1_epi8((char)(last  + 1));
+		const __m128i flip  = _mm_set1_epi8(0x20);
+
+		for ( ; i + 16ul <= to->len; i += 16ul )
+		{
+			__m128i v  = _mm_loadu_si128((__m128i *)&to->str[i]);
+			__m128i in = _mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above));
+
+			_mm_storeu_si128((__m128i *)&to->str[i], _mm_xor_si128(v, _mm_and_si128(in, flip)));
+		}
 	}
-	ezi_cpy(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s2)"  , (uint)s1->len, s1->str);
-	ezi_cat(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cat(from s2)"  , (uint)s1->len, s1->str);
-	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len"           , (uint)s1->len, s1->str);
-	ezi_clr(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_clr"           , (uint)s1->len, s1->str);
-	ezi_dbg(s1, non);		P("%24.24s=len=%2u \"%s\"\n", "ezi_dbg(from non)" , (uint)s1->len, s1->str); // stops early
-	ezi_esc(non, s1);		P("%24.24s=len=%2u \"%s\"\n", "ezi_esc(from s1)"  , (uint)non->len, non->str);
-	ezi_sproc(non, SP_8BIT_NONP | SP_ONE_BLANK, ' ');
-							P("%24.24s=len=%2u \"%s\"\n", "ezi_sproc(non)"    , (uint)non->len, non->str);
-#ifdef EZI_TEST_APP_OVERFLOW
-	ezi_cpy(s1, over  );	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from over)", (uint)s1->len, s1->str);
 #endif
-	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
-	ezi_ltrim(s1, 2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1, 2)"  , (uint)s1->len, s1->str);
-	ezi_rtrim(s1, 2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1, 2)"  , (uint)s1->len, s1->str);
-	ezi_ltrim(s1, 999);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1,999)" , (uint)s1->len, s1->str);
-	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
-	ezi_rtrim(s1, 999);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1,999)" , (uint)s1->len, s1->str);
-	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
-	ezi_ltrim(s1, 20);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1,20)"  , (uint)s1->len, s1->str);
-	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
-	ezi_rtrim(s1, 20);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1,20)"  , (uint)s1->len, s1->str);
-	ezi_cpy_raw(s1, c1);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy_raw(from c1)"  , (uint)s1->len, s1->str);
-	ezi_cpy_raw(s1, c2);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy_raw(from c2)"  , (uint)s1->len, s1->str);
-	ezi_clr(s1);
-	ezi_cat_raw(s1, c1);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cat_raw(from c1)"  , (uint)s1->len, s1->str);
-	ezi_cat_raw(s1, c2);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cat_raw(from c2)"  , (uint)s1->len, s1->str);
-	p1 = ezi_dup_raw(c1);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "p1=ezi_dup_raw(c1)", (uint)p1->max, (uint)p1->len, p1->str );
-	p2 = ezi_calloc(20);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "p2=ezi_calloc(20)", (uint)p2->max, (uint)p2->len, p2->str );
-	ezi_cpy(p1, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s2)"   , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_cpy(p2, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p2,s2)"   , (uint)p2->max, (uint)p2->len, p2->str );
-p1 = ezi_realloc(p1, 30);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_realloc(p1,30)", (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_cpy(p1, s4);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s4)"   , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_cat(p1, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cat(p1,s2)"   , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_cpy(p1, s4);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s4)"   , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_reverse(p1);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_reverse(p1)"  , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_trunc(p1, 16);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_trunc(p1,16)" , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_ltrim(p1, 5);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_ltrim(p1,5)"  , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_rtrim(p1, 5);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_rtrim(p1,5)"  , (uint)p1->max, (uint)p1->len, p1->str );
-	ezi_reverse(p1);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_reverse(p1)"  , (uint)p1->max, (uint)p1->len, p1->str );
 
-	NULLIFY(p1);
-	NULLIFY(p2);
-	return 0;
+	for ( ; i < to->len; i++ )
+	{
+		if ( to->str[i] >= first && to->str[i] <= last )
+			to->str[i] ^= 0x20;
+	}
+	return to;
 }
-#endif // EZI_TEST_APP
+
+EZI_STR_T *ezi_upper(EZI_STR_T *to)
+{
+	return ezi_case(to, 'a', 'z');
+}
+
+EZI_STR_T *ezi_lower(EZI_STR_T *to)
+{
+	return ezi_case(to, 'A', 'Z');
+}
+
+#ifdef EZI_SIMD_DISPATCH
+EZI_TARGET_SSSE3
+static size_t ezi_translate_ssse3(char *str, size_t len, unsigned char map[256], uint16_t rows)
+{
+	const __m128i nibble = _mm_set1_epi8(0x0f);
+	__m128i       table[16];
+	int           row[16];
+	int           n = 0, r, k;
+	size_t        i;
+
+	for ( r = 0; r < 16; r++ )
+	{
+		if ( rows & (1u << r) )
+		{
+			row[n]   = r;
+			table[n] = _mm_loadu_si128((__m128i *)&map[r * 16]);
+			n++;
+		}
+	}
+
+	for ( i = 0ul; i + 16ul <= len; i += 16ul )
+	{
+		__m128i v    = _mm_loadu_si128((__m128i *)&str[i]);
+		__m128i hi   = _mm_and_si128(_mm_srli_epi16(v, 4), nibble);
+		__m128i lo   = _mm_and_si128(v, nibble);
+		__m128i res  = v;
+
+		for ( k = 0; k < n; k++ )
+		{
+			__m128i in = _mm_cmpeq_epi8(hi, _mm_set1_epi8((char)row[k]));
+
+			res = _mm_or_si128(_mm_andnot_si128(in, res), _mm_and_si128(in, _mm_shuffle_epi8(table[k], lo)));
+		}
+		_mm_storeu_si128((__m128i *)&str[i], res);
+	}
+	return i;
+}
+#endif
+
+EZI_STR_T *ezi_translate(EZI_STR_T *to, unsigned char map[256])
+{
+	size_t i = 0ul;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL || map == NULL )
+		return to;
+#endif
+
+#ifdef EZI_SIMD_DISPATCH
+	if ( to->len >= 16ul && EZI_CPU_SSSE3() )
+	{
+		uint16_t rows = 0u;  // Bit r set if map[r*16 .. r*16+15] changes anything.
+		int      n    = 0;
+
+		for ( i = 0ul; i < 256ul; i++ )
+		{
+			if ( map[i] != (unsigned char)i && !(rows & (1u << (i >> 4))) )
+			{
+				rows |= (uint16_t)(1u << (i >> 4));
+				n++;
+			}
+		}
+		i = ( n <= 4 ) ? ezi_translate_ssse3(to->str, to->len, map, rows) : 0ul;
+	}
+#endif
+
+	for ( ; i < to->len; i++ )
+		to->str[i] = (char)map[(unsigned char)to->str[i]];
+
+	return to;
+}
+
+// Steps through a tr-style set, expanding ranges: returns the next character, or -1 at the end.
+typedef struct
+{
+	unsigned char *p;
+	unsigned       next, last;
+} EZI_TR_SET_T;
+
+static int ezi_tr_next(EZI_TR_SET_T *set)
+{
+	if ( set->next <= set->last )
+		return (int)set->next++;
+	if ( set->p == NULL || set->p[0] == '\0' )
+		return -1;
+	if ( set->p[1] == '-' && set->p[2] != '\0' && set->p[2] >= set->p[0] )
+	{
+		set->next = set->p[0];
+		set->last = set->p[2];
+		set->p   += 3;
+		return (int)set->next++;
+	}
+	return *set->p++;
+}
+
+EZI_STR_T *ezi_tr(EZI_STR_T *to, char *from_set, char *to_set)
+{
+	EZI_TR_SET_T  from  = { (unsigned char *)from_set, 1u, 0u };
+	EZI_TR_SET_T  with  = { (unsigned char *)to_set  , 1u, 0u };
+	unsigned char map[256];
+	int           c, w, last_w = -1;
+	unsigned      i;
+
+	for ( i = 0u; i < 256u; i++ )
+		map[i] = (unsigned char)i;
+
+	while ( (c = ezi_tr_next(&from)) >= 0 )
+	{
+		if ( (w = ezi_tr_next(&with)) < 0 )
+			w = last_w;  // to_set is shorter: repeat its last character.
+		if ( w < 0 )
+			break;       // Empty to_set: nothing to do.
+		map[c] = (unsigned char)(last_w = w);
+	}
+
+	return ezi_translate(to, map);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// HIDDEN function which does the bulk of the allocation & initialisation of the new Ezi string.
+static EZI_STR_T *ezi_alloc_private(size_t mem_size, size_t capacity, char *initstr)
+{
+	EZI_STR_T *ptr  = NULL;
+
+	if ( capacity > 0ul )
+	{
+		if ( (ptr = malloc(mem_size)) != NULL )
+		{
+			ptr->max = capacity;
+			ezi_cpy_raw(ptr, initstr);  // Copies string & adjusts 'len'.
+		}
+	}
+	return ptr;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Ezi, and safe, strdup-style call.  Obeys strdup rules.  This creates a full-sized Ezi-String
+copy of the original Ezi-String.  I.e., if the original capacity is 20 bytes, and 5 bytes are used,
+then the duplicate will be 20 bytes in capacity, with 5 bytes used.
+
+RETURN VALUE
+Upon successful completion with size not equal to 0, ezi_dup_full() returns a pointer to the
+allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
+passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
+indicate the error. */
+
+EZI_STR_T *ezi_dup_full(EZI_STR_T *original)
+{
+	size_t    capacity = original->max;
+	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+
+	return ezi_alloc_private(mem_size, capacity, original->str);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* Ezi, and safe, strdup-style call.  Obeys strdup rules.  This creates a part-sized Ezi-String
+copy of the original Ezi-String.  I.e., if the original capacity is 20 bytes, and 5 bytes are used,
+then the duplicate will be 5 bytes in capacity, with 5 bytes used.
+
+RETURN VALUE
+Upon successful completion with size not equal to 0, ezi_dup_part() returns a pointer to the
+allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
+passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
+indicate the error. */
+
+EZI_STR_T *ezi_dup_part(EZI_STR_T *original)
+{
+	size_t    capacity = original->len;
+	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+
+	return ezi_alloc_private(mem_size, capacity, original->str);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* The ezi_dup_raw() allocates space for an EZI_STR_T object whose size in bytes is specified by the
+length of the raw string, *and* *copies* the raw string.
+
+See "Rules regarding malloc()" above.
+
+RETURN VALUE
+Upon successful completion with size not equal to 0, ezi_dup_raw() returns a pointer to the
+allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
+passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
+indicate the error. */
+
+EZI_STR_T *ezi_dup_raw(char *initstr)
+{
+	size_t    capacity = strlen(initstr);
+	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+
+	return ezi_alloc_private(mem_size, capacity, initstr);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* The ezi_calloc() (Ezi Clear Alloc) function allocates unused space for an EZI_STR_T object whose
+size in bytes is specified by size, *and* *clears" the string to "" and the length to 0.
+
+See "Rules regarding malloc()" above.
+
+RETURN VALUE
+Upon successful completion with size not equal to 0, ezi_calloc() returns a pointer to the
+allocated space. If size is 0, either a null pointer or a unique pointer that can be successfully
+passed to free() should be returned. Otherwise, it returns a null pointer and should set errno to
+indicate the error. */
+
+EZI_STR_T *ezi_calloc(size_t capacity)
+{
+	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+
+	return ezi_alloc_private(mem_size, capacity, "");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+/* The ezi_realloc() function changes the size of the EZI_STR_T object pointed to by ptr to the size
+specified by size. If changed to a smaller string, and the old string was bigger, the string is
+truncated and '\0'-terminated.
+
+If ptr is a null pointer, ezi_realloc() is equivalent to ezi_calloc() for the specified size.
+
+See "Rules regarding realloc()" above.
+
+RETURN VALUE
+Upon successful completion with a size not equal to 0, ezi_realloc() returns a pointer to the
+(possibly moved) allocated space. If size is 0, either a null pointer or a unique pointer that can
+be successfully passed to free() should be returned. If there is not enough available memory,
+ezi_realloc() should return a null pointer and set errno to [ENOMEM]. */
+
+EZI_STR_T *ezi_realloc(EZI_STR_T *old_ptr, size_t capacity)
+{
+	EZI_STR_T *new_ptr  = old_ptr;
+	size_t    mem_size = capacity + sizeof(EZI_STR_PRIVATE(ezistr, 1));
+
+	if ( old_ptr == NULL )
+	{
+		new_ptr = ezi_calloc(capacity);
+	}
+	else if ( capacity == 0ul )
+	{
+		free(old_ptr);
+		new_ptr = NULL;
+	}
+	else
+	{
+		if ( (new_ptr = realloc(old_ptr, mem_size)) != NULL )
+		{
+			new_ptr->max = capacity;       // can be bigger or smaller
+			if ( new_ptr->len > new_ptr->max )  // if smaller than the current string length, truncate the string.
+			{
+				new_ptr->len = new_ptr->max;
+				new_ptr->str[new_ptr->len] = '\0';
+#ifdef EZI_UTF8
+				ezi_utf8_backoff(new_ptr, 0ul);
+#endif
+			}
+		}
+		else
+			new_ptr = NULL;
+	}
+	return new_ptr;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/*EZI_STR_T *ezi_EG_helper(EZI_STR_T *p, char *raw_str)
+{
+	if ( p == NULL )
+	{
+		p = ezi_dup_raw(raw_str);
+	}
+
+	return p;
+}*/
+
+//////////////////////////////////////////////////////////////////////////////////////////
+int ezi_snprintf ( EZI_STR_T *ezi, const char *fmt, ... )
+{
+	va_list  args;
+	int      possible_overflow;
+
+	//printf("ezi_snprintf:len,max,str=\"%lu,%lu,%s\"\n", ezi->len, ezi->max, ezi->str); fflush(stdout);
+
+	va_start ( args, fmt );
+	possible_overflow = ezi_vsnprintf ( ezi, fmt, args );
+	va_end ( args );
+
+	//printf("ezi_snprintf:len,max,str=\"%lu,%lu,%s\"\n", ezi->len, ezi->max, ezi->str); fflush(stdout);
+	//printf("possible_overflow:=\"%ld\"\n", possible_overflow); fflush(stdout);
+
+	return possible_overflow;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Use this where the va_list pointer has already been set up.
+int ezi_vsnprintf ( EZI_STR_T *ezi, const char *fmt, va_list args )
+{
+	int possible_overflow;
+
+	possible_overflow = vsnprintf ( ezi->str, ezi->max + 1, fmt, args );
+
+	if ( possible_overflow < 0 || possible_overflow >= (int)ezi->max ) // If overflowed...
+	{
+		ezi_len ( ezi );               // ... recalculate current length
+#ifdef EZI_UTF8
+		if ( possible_overflow != (int)ezi->max )  // Exactly full is not truncated.
+			ezi_utf8_backoff ( ezi, 0ul );
+#endif
+	}
+	else
+	{
+		ezi->len = ( size_t ) possible_overflow;  // Not overflowed: length is OK.
+	}
+
+	return possible_overflow;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Pool of workers for batches of Ezi strings.
+
+ezi_pool_for() splits [0..count) into chunks of 'grain' items and calls fn(begin, end, worker,
+scratch, context) for each chunk.  The calling thread is worker 0 and takes part.  Each worker
+starts with an equal share of the chunks, and a worker which runs out steals half of what is left
+of another worker's share, so uneven records still keep all cores busy.
+
+Every worker has its own 'scratch_size' bytes of scratch space (cache-line aligned, not cleared).
+Results must be written by index (as the ezi_batch_xxx() functions do), which keeps the output
+order the same whatever the number of threads.
+
+Without EZI_THREADS (e.g. on a tiny target) a pool only has worker 0, and everything runs on the
+calling thread.  A NULL pool also runs on the calling thread, but with a NULL scratch pointer.
+A pool runs one ezi_pool_for() at a time: don't call it for the same pool from several threads. */
+
+#define EZI_POOL_LINE 64ul  // Cache line size: keeps each worker's data apart.
+
+#ifdef EZI_THREADS
+typedef struct
+{
+	pthread_mutex_t lock;
+	size_t          next;  // Next chunk to run ...
+	size_t          end;   // ... up to, but not including, this one.
+} EZI_POOL_SHARE_T;
+
+typedef struct
+{
+	struct ezi_pool_struct_tag *pool;
+	unsigned                    worker;
+} EZI_POOL_ARG_T;
+#endif
+
+struct ezi_pool_struct_tag
+{
+	unsigned          threads;       // Number of workers, including the calling thread.
+	size_t            scratch_size;  // Rounded up to a whole number of cache lines.
+	char             *scratch;       // Cache-line aligned, inside ...
+	void             *scratch_mem;   // ... this allocation.
+#ifdef EZI_THREADS
+	EZI_POOL_SHARE_T *share;         // One per worker, each on its own cache line, inside ...
+	void             *share_mem;     // ... this allocation.
+	EZI_POOL_ARG_T   *arg;
+	pthread_t        *tid;
+	pthread_mutex_t   lock;
+	pthread_cond_t    start;
+	pthread_cond_t    done;
+	unsigned          generation;    // Bumped to start each job.
+	unsigned          busy;          // Background workers still in the current job.
+	int               quit;
+	size_t            count;         // The current job ...
+	size_t            grain;
+	EZI_POOL_FN      *fn;
+	void             *context;
+#endif
+};
+
+// Allocates 'size' bytes starting on a cache line: *mem gets what to free().
+static void *ezi_pool_alloc(size_t size, void **mem)
+{
+	if ( (*mem = malloc(size + EZI_POOL_LINE - 1ul)) == NULL )
+		return NULL;
+	return (void *)(((uintptr_t)*mem + EZI_POOL_LINE - 1ul) & ~(uintptr_t)(EZI_POOL_LINE - 1ul));
+}
+
+#define EZI_POOL_SCRATCH(pool,worker) ((pool)->scratch_size ? &(pool)->scratch[(worker) * (pool)->scratch_size] : NULL)
+
+#ifdef EZI_THREADS
+#define EZI_POOL_SHARE(pool,worker) ((EZI_POOL_SHARE_T *)((char *)(pool)->share + (worker) * ezi_pool_share_size()))
+
+static size_t ezi_pool_share_size(void)
+{
+	return (sizeof(EZI_POOL_SHARE_T) + EZI_POOL_LINE - 1ul) / EZI_POOL_LINE * EZI_POOL_LINE;
+}
+
+// Takes the next chunk from 'worker's own share, or steals from another worker: 0 if all done.
+static int ezi_pool_take(EZI_POOL_T *pool, unsigned worker, size_t *chunk)
+{
+	EZI_POOL_SHARE_T *mine = EZI_POOL_SHARE(pool, worker);
+	unsigned          k;
+
+	pthread_mutex_lock(&mine->lock);
+	if ( mine->next < mine->end )
+	{
+		*chunk = mine->next++;
+		pthread_mutex_unlock(&mine->lock);
+		return 1;
+	}
+	pthread_mutex_unlock(&mine->lock);
+
+	for ( k = 1u; k < pool->threads; k++ )
+	{
+		EZI_POOL_SHARE_T *victim = EZI_POOL_SHARE(pool, (worker + k) % pool->threads);
+		size_t            next, end;
+
+		pthread_mutex_lock(&victim->lock);
+		next = victim->next;
+		end  = victim->end;
+		if ( next < end )
+		{
+			next += (end - next) / 2ul;  // Steal the top half: at least one chunk.
+			victim->end = next;
+		}
+		pthread_mutex_unlock(&victim->lock);
+
+		if ( next < end )
+		{
+			pthread_mutex_lock(&mine->lock);
+			mine->next = next + 1ul;
+			mine->end  = end;
+			pthread_mutex_unlock(&mine->lock);
+			*chunk = next;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void ezi_pool_work(EZI_POOL_T *pool, unsigned worker)
+{
+	void  *scratch = EZI_POOL_SCRATCH(pool, worker);
+	size_t chunk;
+
+	while ( ezi_pool_take(pool, worker, &chunk) )
+	{
+		size_t begin = chunk * pool->grain;
+
+		pool->fn(begin, MIN(begin + pool->grain, pool->count), worker, scratch, pool->context);
+	}
+}
+
+static void *ezi_pool_thread(void *arg)
+{
+	EZI_POOL_T *pool = ((EZI_POOL_ARG_T *)arg)->pool;
+	unsigned    me   = ((EZI_POOL_ARG_T *)arg)->worker;
+	unsigned    seen = 0u;
+
+	pthread_mutex_lock(&pool->lock);
+	for ( ;; )
+	{
+		while ( !pool->quit && pool->generation == seen )
+			pthread_cond_wait(&pool->start, &pool->lock);
+		if ( pool->quit )
+			break;
+		seen = pool->generation;
+		pthread_mutex_unlock(&pool->lock);
+
+		ezi_pool_work(pool, me);
+
+		pthread_mutex_lock(&pool->lock);
+		if ( --pool->busy == 0u )
+			pthread_cond_signal(&pool->done);
+	}
+	pthread_mutex_unlock(&pool->lock);
+	return NULL;
+}
+#endif // EZI_THREADS
+
+// 'threads' 0 means one per online CPU.  Returns NULL if out of memory.
+EZI_POOL_T *ezi_pool_create(unsigned threads, size_t scratch_size)
+{
+	EZI_POOL_T *pool;
+	unsigned    w;
+
+	if ( (pool = calloc(1, sizeof(*pool))) == NULL )
+		return NULL;
+
+#ifdef EZI_THREADS
+	if ( threads == 0u )
+	{
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = cpus > 0 ? (unsigned)cpus : 1u;
+	}
+#else
+	threads = 1u;
+#endif
+	pool->threads      = threads;
+	pool->scratch_size = (scratch_size + EZI_POOL_LINE - 1ul) / EZI_POOL_LINE * EZI_POOL_LINE;
+	if ( pool->scratch_size > 0ul
+	  && (pool->scratch = ezi_pool_alloc(pool->scratch_size * threads, &pool->scratch_mem)) == NULL )
+	{
+		free(pool);
+		return NULL;
+	}
+
+#ifdef EZI_THREADS
+	pool->share = ezi_pool_alloc(ezi_pool_share_size() * threads, &pool->share_mem);
+	pool->arg   = malloc(sizeof(EZI_POOL_ARG_T) * threads);
+	pool->tid   = malloc(sizeof(pthread_t) * threads);
+	if ( pool->share == NULL || pool->arg == NULL || pool->tid == NULL )
+	{
+		free(pool->share_mem);
+		free(pool->arg);
+		free(pool->tid);
+		free(pool->scratch_mem);
+		free(pool);
+		return NULL;
+	}
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->start, NULL);
+	pthread_cond_init(&pool->done, NULL);
+	for ( w = 0u; w < threads; w++ )
+		pthread_mutex_init(&EZI_POOL_SHARE(pool, w)->lock, NULL);
+
+	for ( w = 1u; w < threads; w++ )  // Worker 0 is whoever calls ezi_pool_for().
+	{
+		pool->arg[w].pool   = pool;
+		pool->arg[w].worker = w;
+		if ( pthread_create(&pool->tid[w], NULL, ezi_pool_thread, &pool->arg[w]) != 0 )
+		{
+			// Make do with the threads we've got: ezi_pool_destroy() only sees their shares.
+			for ( pool->threads = w; w < threads; w++ )
+				pthread_mutex_destroy(&EZI_POOL_SHARE(pool, w)->lock);
+			break;
+		}
+	}
+#else
+	(void)w;
+#endif
+	return pool;
+}
+
+void ezi_pool_destroy(EZI_POOL_T *pool)
+{
+#ifdef EZI_THREADS
+	unsigned w;
+#endif
+
+	if ( pool == NULL )
+		return;
+
+#ifdef EZI_THREADS
+	pthread_mutex_lock(&pool->lock);
+	pool->quit = 1;
+	pthread_cond_broadcast(&pool->start);
+	pthread_mutex_unlock(&pool->lock);
+	for ( w = 1u; w < pool->threads; w++ )
+		pthread_join(pool->tid[w], NULL);
+	for ( w = 0u; w < pool->threads; w++ )
+		pthread_mutex_destroy(&EZI_POOL_SHARE(pool, w)->lock);
+	pthread_cond_destroy(&pool->done);
+	pthread_cond_destroy(&pool->start);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->share_mem);
+	free(pool->arg);
+	free(pool->tid);
+#endif
+	free(pool->scratch_mem);
+	free(pool);
+}
+
+unsigned ezi_pool_threads(EZI_POOL_T *pool)
+{
+	return pool ? pool->threads : 1u;
+}
+
+void ezi_pool_for(EZI_POOL_T *pool, size_t count, size_t grain, EZI_POOL_FN *fn, void *context)
+{
+	size_t chunks, begin;
+
+	if ( grain == 0ul )
+		grain = 1ul;
+	chunks = (count + grain - 1ul) / grain;
+
+	if ( pool == NULL || pool->threads <= 1u || chunks <= 1ul )
+	{
+		void *scratch = pool ? EZI_POOL_SCRATCH(pool, 0u) : NULL;
+
+		for ( begin = 0ul; begin < count; begin += grain )
+			fn(begin, MIN(begin + grain, count), 0u, scratch, context);
+		return;
+	}
+
+#ifdef EZI_THREADS
+	{
+		unsigned w;
+
+		for ( w = 0u; w < pool->threads; w++ )  // Equal shares to start with.
+		{
+			EZI_POOL_SHARE(pool, w)->next = chunks *  w        / pool->threads;
+			EZI_POOL_SHARE(pool, w)->end  = chunks * (w + 1u) / pool->threads;
+		}
+
+		pthread_mutex_lock(&pool->lock);
+		pool->count   = count;
+		pool->grain   = grain;
+		pool->fn      = fn;
+		pool->context = context;
+		pool->busy    = pool->threads - 1u;
+		pool->generation++;
+		pthread_cond_broadcast(&pool->start);
+		pthread_mutex_unlock(&pool->lock);
+
+		ezi_pool_work(pool, 0u);
+
+		pthread_mutex_lock(&pool->lock);
+		while ( pool->busy > 0u )
+			pthread_cond_wait(&pool->done, &pool->lock);
+		pthread_mutex_unlock(&pool->lock);
+	}
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Batches: the same Ezi operation on each of n Ezi strings, split across a pool (which may be
+NULL).  For the two-string functions, to[i] gets the result from from[i].  ezi_batch_apply() calls
+fn(buf[i], i, scratch, context) for each string, e.g. to ezi_snprintf() each record.
+ezi_batch_strtab() does the same for every string of a packed (or compressed) string table, first
+copying string i into to[i] with ezi_strtab_cpy(). */
+
+#define EZI_BATCH_GRAIN 1024ul  // Strings per chunk: enough to make taking a chunk negligible.
+
+typedef struct
+{
+	EZI_STR_T   **to;
+	EZI_STR_T   **from;
+	EZI_BATCH_FN *fn;
+	void         *context;
+	EZI_STRTAB_T *tab;
+} EZI_BATCH_JOB_T;
+
+static void ezi_batch_apply_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_BATCH_JOB_T *job = context;
+
+	(void)worker;
+	for ( ; begin < end; begin++ )
+		job->fn(job->to[begin], begin, scratch, job->context);
+}
+
+static void ezi_batch_strtab_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_BATCH_JOB_T *job = context;
+
+	(void)worker;
+	for ( ; begin < end; begin++ )
+	{
+		ezi_strtab_cpy(job->to[begin], job->tab, begin);
+		if ( job->fn != NULL )
+			job->fn(job->to[begin], begin, scratch, job->context);
+	}
+}
+
+static void ezi_batch_trail_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_BATCH_JOB_T *job = context;
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+		ezi_trail(job->to[begin]);
+}
+
+static void ezi_batch_cpy_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_BATCH_JOB_T *job = context;
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+		ezi_cpy(job->to[begin], job->from[begin]);
+}
+
+static void ezi_batch_cat_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_BATCH_JOB_T *job = context;
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+		ezi_cat(job->to[begin], job->from[begin]);
+}
+
+void ezi_batch_apply(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, EZI_BATCH_FN *fn, void *context)
+{
+	EZI_BATCH_JOB_T job = { buf, NULL, fn, context, NULL };
+
+	ezi_pool_for(pool, n, EZI_BATCH_GRAIN, ezi_batch_apply_chunk, &job);
+}
+
+// to[] must have ezi_strtab_count(tab) strings.  fn may be NULL, to just unpack the table.
+void ezi_batch_strtab(EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STRTAB_T *tab, EZI_BATCH_FN *fn, void *context)
+{
+	EZI_BATCH_JOB_T job = { to, NULL, fn, context, tab };
+
+	ezi_pool_for(pool, ezi_strtab_count(tab), EZI_BATCH_GRAIN, ezi_batch_strtab_chunk, &job);
+}
+
+void ezi_batch_trail(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n)
+{
+	EZI_BATCH_JOB_T job = { buf, NULL, NULL, NULL, NULL };
+
+	ezi_pool_for(pool, n, EZI_BATCH_GRAIN, ezi_batch_trail_chunk, &job);
+}
+
+void ezi_batch_cpy(EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STR_T *from[], size_t n)
+{
+	EZI_BATCH_JOB_T job = { to, from, NULL, NULL, NULL };
+
+	ezi_pool_for(pool, n, EZI_BATCH_GRAIN, ezi_batch_cpy_chunk, &job);
+}
+
+void ezi_batch_cat(EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STR_T *from[], size_t n)
+{
+	EZI_BATCH_JOB_T job = { to, from, NULL, NULL, NULL };
+
+	ezi_pool_for(pool, n, EZI_BATCH_GRAIN, ezi_batch_cat_chunk, &job);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Sorting arrays of Ezi strings.
+
+Order is that of memcmp() on the bytes, with a shorter string first if it is a prefix of a longer
+one.  With EZI_SORT_NOCASE, 'A'-'Z' compare as 'a'-'z'.
+
+Each string is sorted as an item holding the next 8 bytes of the string (big-endian, so a plain
+integer compare gives byte order) next to its pointer.  Items are sorted on this cached key alone;
+only runs of equal keys go back to the strings, for the next 8 bytes.  So most of the work never
+touches the string data, and never rescans a prefix already known to be equal.
+
+ezi_sort_unique() moves all but the first of each group of equal strings to the end of buf[],
+after the unique strings, and returns the number of unique strings.  Duplicates are found as
+part of the sort: they are the items whose strings end within an equal-key run with equal lengths.
+
+With a multi-threaded pool and a large array, a sample of the strings picks splitters for
+4 buckets per thread.  Strings are counted & scattered into buckets in parallel, and then each
+bucket is sorted as above, also in parallel.  Equal strings always land in the same bucket.
+
+If there is no memory for the items, a plain qsort() is used instead. */
+
+#define EZI_SORT_PARALLEL_MIN 65536ul  // Smaller arrays aren't worth the threads.
+#define EZI_SORT_DUP          1ull     // Key of a duplicate, once sorted.
+
+typedef struct
+{
+	uint64_t   key;
+	EZI_STR_T *s;
+} EZI_SORT_ITEM_T;
+
+// Folds 'A'-'Z' to lower case in all 8 bytes at once.
+static uint64_t ezi_sort_fold(uint64_t x)
+{
+	const uint64_t ones = 0x0101010101010101ull;
+	uint64_t       low7 = x & (0x7f * ones);
+	uint64_t       ge_a = low7 + (0x80 - 'A') * ones;  // Bit 7 set if >= 'A'.
+	uint64_t       gt_z = low7 + (0x7f - 'Z') * ones;  // Bit 7 set if >  'Z'.
+	uint64_t       upper = ge_a & ~gt_z & ~x & (0x80 * ones);
+
+	return x | (upper >> 2);
+}
+
+static uint64_t ezi_sort_key(EZI_STR_T *s, size_t depth, int flags)
+{
+	uint64_t key = 0ull;
+	size_t   i, n = s->len > depth ? MIN(8ul, s->len - depth) : 0ul;
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if ( n == 8ul )
+	{
+		memcpy(&key, &s->str[depth], 8);
+		key = __builtin_bswap64(key);
+	}
+	else
+#endif
+	{
+		for ( i = 0ul; i < n; i++ )
+			key |= (uint64_t)(unsigned char)s->str[depth + i] << (56 - 8 * i);
+	}
+
+	return ( flags & EZI_SORT_NOCASE ) ? ezi_sort_fold(key) : key;
+}
+
+static int ezi_sort_cmp(EZI_STR_T *a, EZI_STR_T *b, int flags)
+{
+	size_t i, n = MIN(a->len, b->len);
+
+	for ( i = 0ul; i < n; i += 8ul )
+	{
+		uint64_t ka = ezi_sort_key(a, i, flags);
+		uint64_t kb = ezi_sort_key(b, i, flags);
+
+		if ( ka != kb )
+			return ka < kb ? -1 : 1;
+	}
+	return a->len < b->len ? -1 : a->len > b->len;
+}
+
+static int ezi_sort_qcmp(const void *a, const void *b)
+{
+	return ezi_sort_cmp(*(EZI_STR_T **)a, *(EZI_STR_T **)b, 0);
+}
+
+static int ezi_sort_qcmp_nocase(const void *a, const void *b)
+{
+	return ezi_sort_cmp(*(EZI_STR_T **)a, *(EZI_STR_T **)b, EZI_SORT_NOCASE);
+}
+
+// Three-way quicksort of the items on their keys.
+static void ezi_sort_keys(EZI_SORT_ITEM_T *a, size_t n)
+{
+	EZI_SORT_ITEM_T t;
+	size_t          i, j, lt, gt;
+	uint64_t        p, x, y, z;
+
+	while ( n > 16ul )
+	{
+		x = a[0].key;
+		y = a[n / 2ul].key;
+		z = a[n - 1ul].key;
+		p = ( x < y ) ? (( y < z ) ? y : ( x < z ) ? z : x) : (( x < z ) ? x : ( y < z ) ? z : y);
+
+		for ( lt = 0ul, i = 0ul, gt = n; i < gt; )
+		{
+			if      ( a[i].key < p ) { t = a[lt]; a[lt++] = a[i]; a[i++] = t; }
+			else if ( a[i].key > p ) { t = a[--gt]; a[gt] = a[i]; a[i] = t; }
+			else                     i++;
+		}
+
+		if ( lt < n - gt )  // Recurse on the smaller side.
+		{
+			ezi_sort_keys(a, lt);
+			a += gt;
+			n -= gt;
+		}
+		else
+		{
+			ezi_sort_keys(&a[gt], n - gt);
+			n = lt;
+		}
+	}
+
+	for ( i = 1ul; i < n; i++ )
+	{
+		for ( t = a[i], j = i; j > 0ul && a[j - 1ul].key > t.key; j-- )
+			a[j] = a[j - 1ul];
+		a[j] = t;
+	}
+}
+
+// Sorts items whose strings are equal before 'depth', with keys loaded for 'depth' if 'loaded'.
+// Leaves each key as EZI_SORT_DUP for a duplicate, or 0.
+//
+// The biggest group of equal keys is sorted on the next 8 bytes by going round again, and only the
+// others by recursion: each of those has at most half the items, so the stack stays O(log n) deep
+// however long the common prefixes are.
+static void ezi_sort_level(EZI_SORT_ITEM_T *a, size_t n, size_t depth, int flags, int loaded)
+{
+	EZI_SORT_ITEM_T t;
+	size_t          i, j, k, done, big_at, big_n, rest_at, rest_n;
+
+	for ( ; n > 0ul; a = &a[big_at], n = big_n, depth += 8ul, loaded = 0 )
+	{
+		if ( !loaded )
+		{
+			for ( i = 0ul; i < n; i++ )
+				a[i].key = ezi_sort_key(a[i].s, depth, flags);
+		}
+		ezi_sort_keys(a, n);
+
+		for ( big_at = big_n = 0ul, i = 0ul; i < n; i = j )
+		{
+			for ( j = i + 1ul; j < n && a[j].key == a[i].key; j++ )
+				;
+			if ( j - i == 1ul )
+			{
+				a[i].key = 0ull;
+				continue;
+			}
+
+			// Strings ending in this key come first (they are prefixes of the rest), in length order.
+			for ( done = i, k = i; k < j; k++ )
+			{
+				if ( a[k].s->len <= depth + 8ul )
+				{
+					t = a[done]; a[done] = a[k]; a[k] = t;
+					a[done].key = a[done].s->len;
+					done++;
+				}
+			}
+			ezi_sort_keys(&a[i], done - i);
+			for ( k = done; k-- > i; )
+				a[k].key = ( k > i && a[k - 1ul].key == a[k].key ) ? EZI_SORT_DUP : 0ull;
+
+			rest_at = done;
+			rest_n  = j - done;
+			if ( rest_n > big_n )  // The new biggest waits: the old one is sorted now.
+			{
+				k = big_at;  big_at = rest_at;  rest_at = k;
+				k = big_n;   big_n  = rest_n;   rest_n  = k;
+			}
+			if ( rest_n > 0ul )
+				ezi_sort_level(&a[rest_at], rest_n, depth + 8ul, flags, 0);
+		}
+	}
+}
+
+#ifdef EZI_THREADS
+typedef struct
+{
+	EZI_STR_T       **buf;
+	EZI_SORT_ITEM_T  *items;     // Keys & pointers in the original order ...
+	EZI_SORT_ITEM_T  *out;       // ... and scattered into buckets.
+	uint16_t         *bucket;    // Bucket of each string.
+	EZI_STR_T       **splitter;  // buckets - 1 of them.
+	size_t           *count;     // [chunk][bucket]: counts, then scatter positions.
+	size_t           *start;     // [bucket]: start of each bucket in 'out', plus the end.
+	size_t            buckets;
+	size_t            grain;
+	int               flags;
+} EZI_SORT_JOB_T;
+
+static void ezi_sort_count_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_SORT_JOB_T *job   = context;
+	size_t         *count = &job->count[begin / job->grain * job->buckets];
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+	{
+		EZI_STR_T *s  = job->buf[begin];
+		size_t     lo = 0ul, hi = job->buckets - 1ul;
+
+		while ( lo < hi )  // Bucket = number of splitters below s.
+		{
+			size_t mid = (lo + hi) / 2ul;
+
+			if ( ezi_sort_cmp(job->splitter[mid], s, job->flags) < 0 )
+				lo = mid + 1ul;
+			else
+				hi = mid;
+		}
+		job->items[begin].key = ezi_sort_key(s, 0ul, job->flags);
+		job->items[begin].s   = s;
+		job->bucket[begin]    = (uint16_t)lo;
+		count[lo]++;
+	}
+}
+
+static void ezi_sort_scatter_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_SORT_JOB_T *job = context;
+	size_t         *pos = &job->count[begin / job->grain * job->buckets];
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+		job->out[pos[job->bucket[begin]]++] = job->items[begin];
+}
+
+static void ezi_sort_bucket_chunk(size_t begin, size_t end, unsigned worker, void *scratch, void *context)
+{
+	EZI_SORT_JOB_T *job = context;
+
+	(void)worker; (void)scratch;
+	for ( ; begin < end; begin++ )
+		ezi_sort_level(&job->out[job->start[begin]], job->start[begin + 1ul] - job->start[begin], 0ul, job->flags, 1);
+}
+
+// Sample sort across the pool: returns the sorted items (to be freed), or NULL if out of memory.
+static EZI_SORT_ITEM_T *ezi_sort_parallel(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags)
+{
+	EZI_SORT_JOB_T   job;
+	EZI_SORT_ITEM_T *sample;
+	size_t           chunks = 4ul * ezi_pool_threads(pool);
+	size_t           samples, b, c, pos;
+
+	job.buf      = buf;
+	job.flags    = flags;
+	job.buckets  = MIN(4ul * ezi_pool_threads(pool), 65535ul);
+	job.grain    = (n + chunks - 1ul) / chunks;
+	chunks       = (n + job.grain - 1ul) / job.grain;
+	samples      = MIN(16ul * job.buckets, n);
+	job.items    = malloc(n * sizeof(EZI_SORT_ITEM_T));
+	job.out      = malloc(n * sizeof(EZI_SORT_ITEM_T));
+	job.bucket   = malloc(n * sizeof(uint16_t));
+	job.splitter = malloc(job.buckets * sizeof(EZI_STR_T *));
+	job.count    = calloc(chunks * job.buckets, sizeof(size_t));
+	job.start    = malloc((job.buckets + 1ul) * sizeof(size_t));
+	sample       = malloc(samples * sizeof(EZI_SORT_ITEM_T));
+
+	if ( job.items && job.out && job.bucket && job.splitter && job.count && job.start && sample )
+	{
+		for ( c = 0ul; c < samples; c++ )  // Evenly spaced sample, so the result is repeatable.
+			sample[c].s = buf[c * (n / samples)];
+		ezi_sort_level(sample, samples, 0ul, flags, 0);
+		for ( b = 1ul; b < job.buckets; b++ )
+			job.splitter[b - 1ul] = sample[b * samples / job.buckets].s;
+
+		ezi_pool_for(pool, n, job.grain, ezi_sort_count_chunk, &job);
+
+		for ( pos = 0ul, b = 0ul; b < job.buckets; b++ )  // Counts to scatter positions.
+		{
+			job.start[b] = pos;
+			for ( c = 0ul; c < chunks; c++ )
+			{
+				size_t count = job.count[c * job.buckets + b];
+
+				job.count[c * job.buckets + b] = pos;
+				pos += count;
+			}
+		}
+		job.start[job.buckets] = pos;
+
+		ezi_pool_for(pool, n, job.grain, ezi_sort_scatter_chunk, &job);
+		ezi_pool_for(pool, job.buckets, 1ul, ezi_sort_bucket_chunk, &job);
+	}
+	else
+	{
+		free(job.out);
+		job.out = NULL;
+	}
+
+	free(job.items);
+	free(job.bucket);
+	free(job.splitter);
+	free(job.count);
+	free(job.start);
+	free(sample);
+	return job.out;
+}
+#endif // EZI_THREADS
+
+// Sorts buf[] & returns the number of unique strings, with the duplicates (if 'unique') after them.
+static size_t ezi_sort_private(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags, int unique)
+{
+	EZI_SORT_ITEM_T *items = NULL;
+	size_t           i, u, d;
+
+	if ( buf == NULL || n < 2ul )
+		return n;
+
+#ifdef EZI_THREADS
+	if ( n >= EZI_SORT_PARALLEL_MIN && ezi_pool_threads(pool) > 1u )
+		items = ezi_sort_parallel(pool, buf, n, flags);
+#else
+	(void)pool;
+#endif
+
+	if ( items == NULL && (items = malloc(n * sizeof(EZI_SORT_ITEM_T))) != NULL )
+	{
+		for ( i = 0ul; i < n; i++ )
+			items[i].s = buf[i];
+		ezi_sort_level(items, n, 0ul, flags, 0);
+	}
+
+	if ( items == NULL )  // Out of memory: do it the slow way.
+	{
+		qsort(buf, n, sizeof(EZI_STR_T *), ( flags & EZI_SORT_NOCASE ) ? ezi_sort_qcmp_nocase : ezi_sort_qcmp);
+		for ( u = 1ul, i = 1ul; unique && i < n; i++ )
+		{
+			if ( ezi_sort_cmp(buf[u - 1ul], buf[i], flags) != 0 )
+			{
+				EZI_STR_T *t = buf[u]; buf[u++] = buf[i]; buf[i] = t;
+			}
+		}
+		return unique ? u : n;
+	}
+
+	for ( u = 0ul, i = 0ul; i < n; i++ )  // Unique strings first ...
+	{
+		if ( !unique || items[i].key != EZI_SORT_DUP )
+			buf[u++] = items[i].s;
+	}
+	for ( d = u, i = 0ul; d < n; i++ )    // ... then the duplicates.
+	{
+		if ( items[i].key == EZI_SORT_DUP )
+			buf[d++] = items[i].s;
+	}
+	free(items);
+	return u;
+}
+
+void ezi_sort(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags)
+{
+	ezi_sort_private(pool, buf, n, flags, 0);
+}
+
+size_t ezi_sort_unique(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags)
+{
+	return ezi_sort_private(pool, buf, n, flags, 1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Head-offset Ezi strings.
+
+An EZI_HEAD_T is an Ezi string 'buf' plus a 'head' offset: the string is buf->str[head .. buf->len),
+and is always '\0'-terminated.  ezi_head_ltrim() just advances 'head', so consuming the front of a
+received command a few bytes at a time costs nothing per call.  The bytes are only moved back to
+the front when an append would otherwise not fit, or when ezi_head_compact() is called to get an
+ordinary Ezi string back. */
+
+EZI_HEAD_T *ezi_head_init(EZI_HEAD_T *h, EZI_STR_T *buf)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( h == NULL )
+		return NULL;
+#endif
+
+	h->buf  = buf;
+	h->head = 0ul;
+	return h;
+}
+
+size_t ezi_head_len(EZI_HEAD_T *h)
+{
+	return h->buf->len - h->head;
+}
+
+EZI_VIEW_T ezi_head_view(EZI_HEAD_T *h)
+{
+	EZI_VIEW_T view;
+
+	view.str = &h->buf->str[h->head];
+	view.len = h->buf->len - h->head;
+	return view;
+}
+
+EZI_HEAD_T *ezi_head_ltrim(EZI_HEAD_T *h, size_t left_trim)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( h == NULL )
+		return NULL;
+#endif
+
+	if ( left_trim >= h->buf->len - h->head )  // All gone: start again at the front, for free.
+	{
+		ezi_clr(h->buf);
+		h->head = 0ul;
+	}
+	else
+		h->head += left_trim;
+
+	return h;
+}
+
+EZI_STR_T *ezi_head_compact(EZI_HEAD_T *h)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( h == NULL )
+		return NULL;
+#endif
+
+	ezi_ltrim(h->buf, h->head);
+	h->head = 0ul;
+	return h->buf;
+}
+
+EZI_HEAD_T *ezi_head_cat_raw(EZI_HEAD_T *h, char *from, size_t from_len)
+{
+	EZI_STR_T *buf;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( h == NULL )
+		return NULL;
+#endif
+
+	buf = h->buf;
+	if ( from_len > buf->max - buf->len && h->head > 0ul )
+		ezi_head_compact(h);  // Only move the string when we need the room.
+
+	from_len = MIN(from_len, buf->max - buf->len);
+	memcpy(&buf->str[buf->len], from, from_len);
+	buf->len += from_len;
+	buf->str[buf->len] = '\0';
+	return h;
+}
+
+EZI_HEAD_T *ezi_head_cat(EZI_HEAD_T *h, EZI_STR_T *from)
+{
+	return ezi_head_cat_raw(h, from->str, from->len);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Byte FIFO (ring buffer), e.g. for serial receive.
+
+The size must be a power of 2.  'head' and 'tail' count all bytes ever consumed & pushed, so
+used = tail - head even after they wrap around.  Only the producer writes 'tail', and only the
+consumer writes 'head'.
+
+With EZI_RING_SPSC, one producer and one consumer may run at the same time without a lock (e.g. an
+ISR pushing while a task pops, or two threads): each index is published with release semantics and
+read with acquire semantics, so the bytes are always visible before the index that covers them.
+Without it, there is no synchronisation at all, which costs nothing on a single thread.
+EZI_RING_SPSC needs GCC-style __atomic builtins: without them ezi_ring_init() refuses it, and an
+EZI_RING() with it doesn't compile.
+
+ezi_ring_push() pushes what fits and returns how many bytes that was.  ezi_ring_peek_view() shows
+the readable bytes up to the end of the buffer (so call it again after ezi_ring_consume() to see
+any wrapped part).  ezi_ring_pop_line() pops a '\n'-terminated line (without the "\r\n" or "\n")
+into an Ezi string, truncating it if too long, but always consuming all of it.  If the ring is
+full without a '\n', that is popped as a line, since it could never complete. */
+
+#if defined(__GNUC__)
+#define EZI_RING_LOAD(ring,index) \
+	(((ring)->flags & EZI_RING_SPSC) ? __atomic_load_n(&(ring)->index, __ATOMIC_ACQUIRE) : (ring)->index)
+#define EZI_RING_STORE(ring,index,value) \
+	do { if ( (ring)->flags & EZI_RING_SPSC ) __atomic_store_n(&(ring)->index, (value), __ATOMIC_RELEASE); \
+	     else (ring)->index = (value); } while ( 0 )
+#else // No atomics: only safe for single-threaded use, so ezi_ring_init() refuses EZI_RING_SPSC.
+#define EZI_RING_LOAD(ring,index)        ((ring)->index)
+#define EZI_RING_STORE(ring,index,value) ((ring)->index = (value))
+#endif
+
+EZI_RING_T *ezi_ring_init(EZI_RING_T *ring, char *buf, size_t size, int flags)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( ring == NULL || buf == NULL )
+		return NULL;
+#endif
+
+	if ( size == 0ul || (size & (size - 1ul)) != 0ul )
+		return NULL;  // Not a power of 2.
+#if !defined(__GNUC__)
+	if ( flags & EZI_RING_SPSC )
+		return NULL;  // No atomics to make it safe with.
+#endif
+
+	ring->buf   = buf;
+	ring->size  = size;
+	ring->head  = 0ul;
+	ring->tail  = 0ul;
+	ring->flags = flags;
+	return ring;
+}
+
+// Consumer or producer: the other side may change the answer at any time.
+size_t ezi_ring_used(EZI_RING_T *ring)
+{
+	return EZI_RING_LOAD(ring, tail) - EZI_RING_LOAD(ring, head);
+}
+
+size_t ezi_ring_room(EZI_RING_T *ring)
+{
+	return ring->size - ezi_ring_used(ring);
+}
+
+// Producer only.
+size_t ezi_ring_push_raw(EZI_RING_T *ring, char *from, size_t from_len)
+{
+	size_t tail = ring->tail;
+	size_t at   = tail & (ring->size - 1ul);
+	size_t n    = MIN(from_len, ring->size - (tail - EZI_RING_LOAD(ring, head)));
+	size_t first = MIN(n, ring->size - at);
+
+	memcpy(&ring->buf[at], from, first);
+	memcpy(ring->buf, &from[first], n - first);
+	EZI_RING_STORE(ring, tail, tail + n);
+	return n;
+}
+
+size_t ezi_ring_push(EZI_RING_T *ring, EZI_STR_T *from)
+{
+	return ezi_ring_push_raw(ring, from->str, from->len);
+}
+
+// Consumer only.
+EZI_VIEW_T ezi_ring_peek_view(EZI_RING_T *ring)
+{
+	EZI_VIEW_T view;
+	size_t     head = ring->head;
+	size_t     at   = head & (ring->size - 1ul);
+
+	view.str = &ring->buf[at];
+	view.len = MIN(EZI_RING_LOAD(ring, tail) - head, ring->size - at);
+	return view;
+}
+
+void ezi_ring_consume(EZI_RING_T *ring, size_t n)
+{
+	size_t head = ring->head;
+
+	EZI_RING_STORE(ring, head, head + MIN(n, EZI_RING_LOAD(ring, tail) - head));
+}
+
+// Copies 'n' bytes starting 'offset' bytes after the head, without consuming them.
+static void ezi_ring_copy(EZI_RING_T *ring, size_t offset, char *to, size_t n)
+{
+	size_t at    = (ring->head + offset) & (ring->size - 1ul);
+	size_t first = MIN(n, ring->size - at);
+
+	memcpy(to, &ring->buf[at], first);
+	memcpy(&to[first], ring->buf, n - first);
+}
+
+size_t ezi_ring_pop_raw(EZI_RING_T *ring, char *to, size_t max)
+{
+	size_t n = MIN(max, EZI_RING_LOAD(ring, tail) - ring->head);
+
+	ezi_ring_copy(ring, 0ul, to, n);
+	ezi_ring_consume(ring, n);
+	return n;
+}
+
+EZI_STR_T *ezi_ring_pop_line(EZI_RING_T *ring, EZI_STR_T *to)
+{
+	size_t used = EZI_RING_LOAD(ring, tail) - ring->head;
+	size_t at   = ring->head & (ring->size - 1ul);
+	size_t first = MIN(used, ring->size - at);
+	size_t line, eol;
+	char  *nl;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL )
+		return NULL;
+#endif
+
+	if ( (nl = memchr(&ring->buf[at], '\n', first)) != NULL )
+		line = (size_t)(nl - &ring->buf[at]);
+	else if ( (nl = memchr(ring->buf, '\n', used - first)) != NULL )
+		line = first + (size_t)(nl - ring->buf);
+	else if ( used == ring->size )
+		line = used;  // Full, with no end of line: it would never come.
+	else
+		return NULL;
+
+	eol = ( line < used ) ? 1ul : 0ul;
+	to->len = MIN(line, to->max);
+	ezi_ring_copy(ring, 0ul, to->str, to->len);
+	if ( to->len == line && line > 0ul && to->str[line - 1ul] == '\r' )
+		to->len--;
+	to->str[to->len] = '\0';
+#ifdef EZI_UTF8
+	if ( line > to->max )
+		ezi_utf8_backoff(to, 0ul);
+#endif
+
+	ezi_ring_consume(ring, line + eol);
+	return to;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Slow paths for the inline ezi_builder_xxx() functions in ezi_str.h: a non-ASCII byte, or
+anything which doesn't fit.  These do exactly what ezi_ch() & ezi_cat() would have done, including
+the EZI_UTF8 rules, so that a finished builder matches the equivalent ezi_ch()/ezi_cat() calls. */
+
+void ezi_builder_ch_private(EZI_BUILDER_T *b, int ch_integer)
+{
+	if ( b->room == 0ul )
+	{
+		b->truncated = 1;
+		return;
+	}
+#ifdef EZI_UTF8
+	b->buf->len = (size_t)(b->at - b->buf->str);
+	if ( !ezi_utf8_ch_fits(b->buf, ch_integer) )
+	{
+		b->truncated = 1;
+		return;
+	}
+#endif
+	*b->at++ = (char)ch_integer;
+	b->room--;
+}
+
+void ezi_builder_mem_private(EZI_BUILDER_T *b, char *from, size_t from_len)
+{
+	size_t n = MIN(from_len, b->room);
+
+	memcpy(b->at, from, n);
+	b->at   += n;
+	b->room -= n;
+	if ( n < from_len )
+	{
+		b->truncated = 1;
+#ifdef EZI_UTF8
+		{
+			size_t old_len = (size_t)(b->at - b->buf->str) - n;
+			size_t new_len = MAX(old_len, ezi_utf8_cut(b->buf->str, old_len + n));
+
+			b->room += old_len + n - new_len;
+			b->at    = &b->buf->str[new_len];
+		}
+#endif
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Number parsers for a field inside an Ezi string, buf->str[offset .. offset+len), or a view.
+
+No '\0' is needed, the locale is never consulted, leading/trailing spaces are NOT skipped, and
+nothing is allocated.  'len' is clamped to the end of the string, so (size_t)-1 means "to the end".
+
+Returns EZI_NUM_OK, or:
+	EZI_NUM_EMPTY     no number at the start of the field: *value is 0.
+	EZI_NUM_OVERFLOW  out of range: *value is clamped to the nearest limit (or +/-HUGE_VAL).
+	EZI_NUM_TRAILING  a number followed by something else: *value is that number.
+
+Decimal digits are converted 8 at a time with SWAR (one 64-bit load, a validity test and three
+multiplies) where the CPU is little-endian.
+
+ezi_to_double() accepts [+-]digits[.digits][(e|E)[+-]digits], ".5", "inf", "infinity" & "nan"
+(any case).  It is exact: up to 19 significant digits with a power of ten up to 10^22 (most real
+data) is done with one correctly rounded IEEE multiply or divide.  Any other power of ten is done
+by Eisel & Lemire's method: one or two 64x128-bit multiplies by a truncated 5^q from a table,
+which is always exact for 19 digits (Mushtak & Lemire, "Fast Number Parsing Without Fallback").
+Longer numbers are cut to 19 digits, w, and converted at both w and w+1: if both give the same
+double, that's the answer.  Only if not (the number is within a digit of halfway between two
+doubles) is it normalised to "<digits>e<exponent>" (no decimal point, so locale-free) and
+converted by strtod(), using the first 768 significant digits plus a sticky digit for any nonzero
+digits beyond them.  A double never needs more: halfway between two doubles has at most 767, so
+the rounding is still exact. */
+
+#define EZI_NUM_SIG_MAX 19   // Decimal digits which always fit in a uint64_t.
+#define EZI_NUM_SLOW_MAX 768 // Significant digits kept for the strtod() path.
+
+static const double ezi_pow10[] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define EZI_NUM_POW5_MIN (-342) // Below this, 19 digits are less than half the smallest double.
+#define EZI_NUM_POW5_MAX 308    // Above this, anything but 0 is too large for a double.
+
+// The top 128 bits of 5^q, q = EZI_NUM_POW5_MIN .. EZI_NUM_POW5_MAX, shifted left until bit 127 is
+// set, as {high, low}.  Truncated for q >= 0; for q < 0, 1 more than the truncated reciprocal.
+static const uint64_t ezi_pow5_128[][2] =
+{
+	{ 0xeef453d6923bd65aull, 0x113faa2906a13b3full }, { 0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull },
+	{ 0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull }, { 0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull },
+	{ 0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull }, { 0xb64ec836a47146f9ull, 0x9748e2826cdee284ull },
+	{ 0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull }, { 0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull },
+	{ 0xb208ef855c969f4full, 0xbdbd2d335e51a935ull }, { 0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull },
+	{ 0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull }, { 0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull },
+	{ 0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull }, { 0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull },
+	{ 0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull }, { 0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull },
+	{ 0x84a57695fe98746dull, 0x014bb630f7604b57ull }, { 0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull },
+	{ 0xcf42894a5dce35eaull, 0x52064cac828675b9ull }, { 0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull },
+	{ 0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull }, { 0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull },
+	{ 0xfd00b897478238d0ull, 0x8920b098955522b4ull }, { 0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull },
+	{ 0xc5a890362fddbc62ull, 0xeb2189f734aa831dull }, { 0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull },
+	{ 0x9a6bb0aa55653b2dull, 0x47b233c92125366eull }, { 0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull },
+	{ 0xf148440a256e2c76ull, 0xc00670ea43ca250dull }, { 0x96cd2a865764dbcaull, 0x380406926a5e5728ull },
+	{ 0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull }, { 0xeba09271e88d976bull, 0xf7864a44c633682eull },
+	{ 0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull }, { 0xb8157268fdae9e4cull, 0x5960ea05bad82964ull },
+	{ 0xe61acf033d1a45dfull, 0x6fb92487298e33bdull }, { 0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull },
+	{ 0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull }, { 0xe0b62e2929aba83cull, 0x331acdabfe94de87ull },
+	{ 0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull }, { 0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull },
+	{ 0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull }, { 0x892731ac9faf056eull, 0xbe311c083a225cd2ull },
+	{ 0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull }, { 0xd64d3d9db981787dull, 0x092cbbccdad5b108ull },
+	{ 0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull }, { 0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull },
+	{ 0xd1476e2c07286faaull, 0x1af5af660db4aee1ull }, { 0x82cca4db847945caull, 0x50d98d9fc890ed4dull },
+	{ 0xa37fce126597973cull, 0xe50ff107bab528a0ull }, { 0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull },
+	{ 0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull }, { 0x9faacf3df73609b1ull, 0x77b191618c54e9acull },
+	{ 0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull }, { 0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull },
+	{ 0x9becce62836ac577ull, 0x4ee367f9430aec32ull }, { 0xc2e801fb244576d5ull, 0x229c41f793cda73full },
+	{ 0xf3a20279ed56d48aull, 0x6b43527578c1110full }, { 0x9845418c345644d6ull, 0x830a13896b78aaa9ull },
+	{ 0xbe5691ef416bd60cull, 0x23cc986bc656d553ull }, { 0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull },
+	{ 0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull }, { 0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull },
+	{ 0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull }, { 0x91376c36d99995beull, 0x23100809b9c21fa1ull },
+	{ 0xb58547448ffffb2dull, 0xabd40a0c2832a78aull }, { 0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull },
+	{ 0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull }, { 0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull },
+	{ 0xdd95317f31c7fa1dull, 0x40405643d711d583ull }, { 0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull },
+	{ 0xad1c8eab5ee43b66ull, 0xda3243650005eecfull }, { 0xd863b256369d4a40ull, 0x90bed43e40076a82ull },
+	{ 0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull }, { 0xa90de3535aaae202ull, 0x711515d0a205cb36ull },
+	{ 0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull }, { 0x8412d9991ed58091ull, 0xe858790afe9486c2ull },
+	{ 0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull }, { 0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full },
+	{ 0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull }, { 0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull },
+	{ 0xc987434744ac874eull, 0xa327ffb266b56220ull }, { 0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull },
+	{ 0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull }, { 0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull },
+	{ 0xf6019da07f549b2bull, 0x7e2a53a146606a48ull }, { 0x99c102844f94e0fbull, 0x2eda7444cbfc426dull },
+	{ 0xc0314325637a1939ull, 0xfa911155fefb5308ull }, { 0xf03d93eebc589f88ull, 0x793555ab7eba27caull },
+	{ 0x96267c7535b763b5ull, 0x4bc1558b2f3458deull }, { 0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull },
+	{ 0xea9c227723ee8bcbull, 0x465e15a979c1cadcull }, { 0x92a1958a7675175full, 0x0bfacd89ec191ec9ull },
+	{ 0xb749faed14125d36ull, 0xcef980ec671f667bull }, { 0xe51c79a85916f484ull, 0x82b7e12780e7401aull },
+	{ 0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull }, { 0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull },
+	{ 0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull }, { 0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull },
+	{ 0xaecc49914078536dull, 0x58fae9f773886e18ull }, { 0xda7f5bf590966848ull, 0xaf39a475506a899eull },
+	{ 0x888f99797a5e012dull, 0x6d8406c952429603ull }, { 0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull },
+	{ 0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull }, { 0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full },
+	{ 0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull }, { 0xd0601d8efc57b08bull, 0xf13b94daf124da26ull },
+	{ 0x823c12795db6ce57ull, 0x76c53d08d6b70858ull }, { 0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull },
+	{ 0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull }, { 0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull },
+	{ 0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull }, { 0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull },
+	{ 0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull }, { 0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull },
+	{ 0xc21094364dfb5636ull, 0x985915fc12f542e4ull }, { 0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull },
+	{ 0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull }, { 0xbd8430bd08277231ull, 0x50c6ff782a838353ull },
+	{ 0xece53cec4a314ebdull, 0xa4f8bf5635246428ull }, { 0x940f4613ae5ed136ull, 0x871b7795e136be99ull },
+	{ 0xb913179899f68584ull, 0x28e2557b59846e3full }, { 0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull },
+	{ 0x9096ea6f3848984full, 0x3ff0d2c85def7621ull }, { 0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull },
+	{ 0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull }, { 0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull },
+	{ 0xb080392cc4349decull, 0xbd8d794d96aacfb3ull }, { 0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull },
+	{ 0x89e42caaf9491b60ull, 0xf41686c49db57244ull }, { 0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull },
+	{ 0xd77485cb25823ac7ull, 0x7d633293366b828bull }, { 0x86a8d39ef77164bcull, 0xae5dff9c02033197ull },
+	{ 0xa8530886b54dbdebull, 0xd9f57f830283fdfcull }, { 0xd267caa862a12d66ull, 0xd072df63c324fd7bull },
+	{ 0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull }, { 0xa46116538d0deb78ull, 0x52d9be85f074e608ull },
+	{ 0xcd795be870516656ull, 0x67902e276c921f8bull }, { 0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull },
+	{ 0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull }, { 0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull },
+	{ 0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull }, { 0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull },
+	{ 0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull }, { 0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull },
+	{ 0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull }, { 0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull },
+	{ 0xef340a98172aace4ull, 0x86fb897116c87c34ull }, { 0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull },
+	{ 0xbae0a846d2195712ull, 0x8974836059cca109ull }, { 0xe998d258869facd7ull, 0x2bd1a438703fc94bull },
+	{ 0x91ff83775423cc06ull, 0x7b6306a34627ddcfull }, { 0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull },
+	{ 0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull }, { 0x8e938662882af53eull, 0x547eb47b7282ee9cull },
+	{ 0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull }, { 0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull },
+	{ 0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull }, { 0xae0b158b4738705eull, 0x9624ab50b148d445ull },
+	{ 0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull }, { 0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull },
+	{ 0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull }, { 0xd47487cc8470652bull, 0x7647c3200069671full },
+	{ 0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull }, { 0xa5fb0a17c777cf09ull, 0xf468107100525890ull },
+	{ 0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull }, { 0x81ac1fe293d599bfull, 0xc6f14cd848405530ull },
+	{ 0xa21727db38cb002full, 0xb8ada00e5a506a7cull }, { 0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull },
+	{ 0xfd442e4688bd304aull, 0x908f4a166d1da663ull }, { 0x9e4a9cec15763e2eull, 0x9a598e4e043287feull },
+	{ 0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull }, { 0xf7549530e188c128ull, 0xd12bee59e68ef47cull },
+	{ 0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull }, { 0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull },
+	{ 0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull }, { 0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull },
+	{ 0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull }, { 0xebdf661791d60f56ull, 0x111b495b3464ad21ull },
+	{ 0x936b9fcebb25c995ull, 0xcab10dd900beec34ull }, { 0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull },
+	{ 0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull }, { 0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull },
+	{ 0xb3f4e093db73a093ull, 0x59ed216765690f56ull }, { 0xe0f218b8d25088b8ull, 0x306869c13ec3532cull },
+	{ 0x8c974f7383725573ull, 0x1e414218c73a13fbull }, { 0xafbd2350644eeacfull, 0xe5d1929ef90898faull },
+	{ 0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull }, { 0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull },
+	{ 0xab9eb47c81f5114full, 0x066ea92f3f326564ull }, { 0xd686619ba27255a2ull, 0xc80a537b0efefebdull },
+	{ 0x8613fd0145877585ull, 0xbd06742ce95f5f36ull }, { 0xa798fc4196e952e7ull, 0x2c48113823b73704ull },
+	{ 0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull }, { 0x82ef85133de648c4ull, 0x9a984d73dbe722fbull },
+	{ 0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull }, { 0xcc963fee10b7d1b3ull, 0x318df905079926a8ull },
+	{ 0xffbbcfe994e5c61full, 0xfdf17746497f7052ull }, { 0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull },
+	{ 0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull }, { 0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull },
+	{ 0x9c1661a651213e2dull, 0x06bea10ca65c084eull }, { 0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull },
+	{ 0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull }, { 0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull },
+	{ 0xbe89523386091465ull, 0xf6bbb397f1135823ull }, { 0xee2ba6c0678b597full, 0x746aa07ded582e2cull },
+	{ 0x94db483840b717efull, 0xa8c2a44eb4571cdcull }, { 0xba121a4650e4ddebull, 0x92f34d62616ce413ull },
+	{ 0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull }, { 0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull },
+	{ 0xb5b5ada8aaff80b8ull, 0x0d819992132456baull }, { 0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull },
+	{ 0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull }, { 0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull },
+	{ 0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull }, { 0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull },
+	{ 0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull }, { 0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull },
+	{ 0x87625f056c7c4a8bull, 0x11471cd764ad4972ull }, { 0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull },
+	{ 0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull }, { 0x843610cb4bf160cbull, 0xcedf722a585139baull },
+	{ 0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull }, { 0xce947a3da6a9273eull, 0x733d226229feea32ull },
+	{ 0x811ccc668829b887ull, 0x0806357d5a3f525full }, { 0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull },
+	{ 0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull }, { 0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull },
+	{ 0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull }, { 0xc5029163f384a931ull, 0x0a9e795e65d4df11ull },
+	{ 0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull }, { 0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull },
+	{ 0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull }, { 0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull },
+	{ 0x964e858c91ba2655ull, 0x3a6a07f8d510f86full }, { 0xbbe226efb628afeaull, 0x890489f70a55368bull },
+	{ 0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull }, { 0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull },
+	{ 0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull }, { 0xe55990879ddcaabdull, 0xcc420a6a101d0515ull },
+	{ 0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull }, { 0xb32df8e9f3546564ull, 0x47939822dc96abf9ull },
+	{ 0xdff9772470297ebdull, 0x59787e2b93bc56f7ull }, { 0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull },
+	{ 0xaefae51477a06b03ull, 0xede622920b6b23f1ull }, { 0xdab99e59958885c4ull, 0xe95fab368e45ecedull },
+	{ 0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull }, { 0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull },
+	{ 0xd59944a37c0752a2ull, 0x4be76d3346f0495full }, { 0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull },
+	{ 0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull }, { 0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull },
+	{ 0x825ecc24c873782full, 0x8ed400668c0c28c8ull }, { 0xa2f67f2dfa90563bull, 0x728900802f0f32faull },
+	{ 0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull }, { 0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull },
+	{ 0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull }, { 0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull },
+	{ 0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull }, { 0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull },
+	{ 0xc24452da229b021bull, 0xfbe85badce996168ull }, { 0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull },
+	{ 0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull }, { 0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull },
+	{ 0xed246723473e3813ull, 0x290123e9aab23b68ull }, { 0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull },
+	{ 0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull }, { 0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull },
+	{ 0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull }, { 0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull },
+	{ 0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull }, { 0x8d590723948a535full, 0x579c487e5a38ad0eull },
+	{ 0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull }, { 0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull },
+	{ 0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull }, { 0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full },
+	{ 0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full }, { 0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull },
+	{ 0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull }, { 0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull },
+	{ 0x83a3eeeef9153e89ull, 0x1953cf68300424acull }, { 0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull },
+	{ 0xcdb02555653131b6ull, 0x3792f412cb06794dull }, { 0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull },
+	{ 0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull }, { 0xc8de047564d20a8bull, 0xf245825a5a445275ull },
+	{ 0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull }, { 0x9ced737bb6c4183dull, 0x55464dd69685606bull },
+	{ 0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull }, { 0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull },
+	{ 0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull }, { 0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull },
+	{ 0xef73d256a5c0f77cull, 0x963e66858f6d4440ull }, { 0x95a8637627989aadull, 0xdde7001379a44aa8ull },
+	{ 0xbb127c53b17ec159ull, 0x5560c018580d5d52ull }, { 0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull },
+	{ 0x9226712162ab070dull, 0xcab3961304ca70e8ull }, { 0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull },
+	{ 0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull }, { 0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull },
+	{ 0xb267ed1940f1c61cull, 0x55f038b237591ed3ull }, { 0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull },
+	{ 0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull }, { 0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull },
+	{ 0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull }, { 0x881cea14545c7575ull, 0x7e50d64177da2e54ull },
+	{ 0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull }, { 0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull },
+	{ 0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull }, { 0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull },
+	{ 0xcfb11ead453994baull, 0x67de18eda5814af2ull }, { 0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull },
+	{ 0xa2425ff75e14fc31ull, 0xa1258379a94d028dull }, { 0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull },
+	{ 0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull }, { 0x9e74d1b791e07e48ull, 0x775ea264cf55347eull },
+	{ 0xc612062576589ddaull, 0x95364afe032a819eull }, { 0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull },
+	{ 0x9abe14cd44753b52ull, 0xc4926a9672793543ull }, { 0xc16d9a0095928a27ull, 0x75b7053c0f178294ull },
+	{ 0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull }, { 0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull },
+	{ 0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull }, { 0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull },
+	{ 0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull }, { 0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull },
+	{ 0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull }, { 0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull },
+	{ 0xb424dc35095cd80full, 0x538484c19ef38c95ull }, { 0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull },
+	{ 0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull }, { 0xafebff0bcb24aafeull, 0xf78f69a51539d749ull },
+	{ 0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull }, { 0x89705f4136b4a597ull, 0x31680a88f8953031ull },
+	{ 0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull }, { 0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull },
+	{ 0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull }, { 0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull },
+	{ 0xd1b71758e219652bull, 0xd3c36113404ea4a9ull }, { 0x83126e978d4fdf3bull, 0x645a1cac083126eaull },
+	{ 0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull }, { 0xccccccccccccccccull, 0xcccccccccccccccdull },
+	{ 0x8000000000000000ull, 0x0000000000000000ull }, { 0xa000000000000000ull, 0x0000000000000000ull },
+	{ 0xc800000000000000ull, 0x0000000000000000ull }, { 0xfa00000000000000ull, 0x0000000000000000ull },
+	{ 0x9c40000000000000ull, 0x0000000000000000ull }, { 0xc350000000000000ull, 0x0000000000000000ull },
+	{ 0xf424000000000000ull, 0x0000000000000000ull }, { 0x9896800000000000ull, 0x0000000000000000ull },
+	{ 0xbebc200000000000ull, 0x0000000000000000ull }, { 0xee6b280000000000ull, 0x0000000000000000ull },
+	{ 0x9502f90000000000ull, 0x0000000000000000ull }, { 0xba43b74000000000ull, 0x0000000000000000ull },
+	{ 0xe8d4a51000000000ull, 0x0000000000000000ull }, { 0x9184e72a00000000ull, 0x0000000000000000ull },
+	{ 0xb5e620f480000000ull, 0x0000000000000000ull }, { 0xe35fa931a0000000ull, 0x0000000000000000ull },
+	{ 0x8e1bc9bf04000000ull, 0x0000000000000000ull }, { 0xb1a2bc2ec5000000ull, 0x0000000000000000ull },
+	{ 0xde0b6b3a76400000ull, 0x0000000000000000ull }, { 0x8ac7230489e80000ull, 0x0000000000000000ull },
+	{ 0xad78ebc5ac620000ull, 0x0000000000000000ull }, { 0xd8d726b7177a8000ull, 0x0000000000000000ull },
+	{ 0x878678326eac9000ull, 0x0000000000000000ull }, { 0xa968163f0a57b400ull, 0x0000000000000000ull },
+	{ 0xd3c21bcecceda100ull, 0x0000000000000000ull }, { 0x84595161401484a0ull, 0x0000000000000000ull },
+	{ 0xa56fa5b99019a5c8ull, 0x0000000000000000ull }, { 0xcecb8f27f4200f3aull, 0x0000000000000000ull },
+	{ 0x813f3978f8940984ull, 0x4000000000000000ull }, { 0xa18f07d736b90be5ull, 0x5000000000000000ull },
+	{ 0xc9f2c9cd04674edeull, 0xa400000000000000ull }, { 0xfc6f7c4045812296ull, 0x4d00000000000000ull },
+	{ 0x9dc5ada82b70b59dull, 0xf020000000000000ull }, { 0xc5371912364ce305ull, 0x6c28000000000000ull },
+	{ 0xf684df56c3e01bc6ull, 0xc732000000000000ull }, { 0x9a130b963a6c115cull, 0x3c7f400000000000ull },
+	{ 0xc097ce7bc90715b3ull, 0x4b9f100000000000ull }, { 0xf0bdc21abb48db20ull, 0x1e86d40000000000ull },
+	{ 0x96769950b50d88f4ull, 0x1314448000000000ull }, { 0xbc143fa4e250eb31ull, 0x17d955a000000000ull },
+	{ 0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull }, { 0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull },
+	{ 0xb7abc627050305adull, 0xf14a3d9e40000000ull }, { 0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull },
+	{ 0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull }, { 0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull },
+	{ 0xe0352f62a19e306eull, 0xd50b2037ad200000ull }, { 0x8c213d9da502de45ull, 0x4526f422cc340000ull },
+	{ 0xaf298d050e4395d6ull, 0x9670b12b7f410000ull }, { 0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull },
+	{ 0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull }, { 0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull },
+	{ 0xd5d238a4abe98068ull, 0x72a4904598d6d880ull }, { 0x85a36366eb71f041ull, 0x47a6da2b7f864750ull },
+	{ 0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull }, { 0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull },
+	{ 0x82818f1281ed449full, 0xbff8f10e7a8921a4ull }, { 0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull },
+	{ 0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull }, { 0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull },
+	{ 0x9f4f2726179a2245ull, 0x01d762422c946590ull }, { 0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull },
+	{ 0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull }, { 0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full },
+	{ 0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull }, { 0xf316271c7fc3908aull, 0x8bef464e3945ef7aull },
+	{ 0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull }, { 0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull },
+	{ 0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull }, { 0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull },
+	{ 0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull }, { 0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull },
+	{ 0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull }, { 0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull },
+	{ 0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull }, { 0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull },
+	{ 0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull }, { 0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull },
+	{ 0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull }, { 0xacb92ed9397bf996ull, 0x49c2c37f07965404ull },
+	{ 0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull }, { 0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull },
+	{ 0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull }, { 0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull },
+	{ 0x83c7088e1aab65dbull, 0x792667c6da79e0faull }, { 0xa4b8cab1a1563f52ull, 0x577001b891185938ull },
+	{ 0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull }, { 0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull },
+	{ 0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull }, { 0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull },
+	{ 0xfb5878494ace3a5full, 0x04ab48a04065c723ull }, { 0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull },
+	{ 0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull }, { 0xf5746577930d6500ull, 0xca8f44ec7ee36479ull },
+	{ 0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull }, { 0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull },
+	{ 0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull }, { 0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull },
+	{ 0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull }, { 0xea1575143cf97226ull, 0xf52d09d71a3293bdull },
+	{ 0x924d692ca61be758ull, 0x593c2626705f9c56ull }, { 0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull },
+	{ 0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull }, { 0x8edf98b59a373fecull, 0x4724bd4189bd5eacull },
+	{ 0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull }, { 0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull },
+	{ 0x8b865b215899f46cull, 0xbd79e0d20082ee74ull }, { 0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull },
+	{ 0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull }, { 0x884134fe908658b2ull, 0x3109058d147fdcddull },
+	{ 0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull }, { 0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull },
+	{ 0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull }, { 0xa6539930bf6bff45ull, 0x84db8346b786151cull },
+	{ 0xcfe87f7cef46ff16ull, 0xe612641865679a63ull }, { 0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull },
+	{ 0xa26da3999aef7749ull, 0xe3be5e330f38f09dull }, { 0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull },
+	{ 0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull }, { 0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull },
+	{ 0xc646d63501a1511dull, 0xb281e1fd541501b8ull }, { 0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull },
+	{ 0x9ae757596946075full, 0x3375788de9b06958ull }, { 0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull },
+	{ 0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull }, { 0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull },
+	{ 0xbd176620a501fbffull, 0xb650e5a93bc3d898ull }, { 0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull },
+	{ 0x93ba47c980e98cdfull, 0xc66f336c36b10137ull }, { 0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull },
+	{ 0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull }, { 0x9043ea1ac7e41392ull, 0x87c89837ad68db2full },
+	{ 0xb454e4a179dd1877ull, 0x29babe4598c311fbull }, { 0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull },
+	{ 0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull }, { 0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full },
+	{ 0xdc21a1171d42645dull, 0x76707543f4fa1f73ull }, { 0x899504ae72497ebaull, 0x6a06494a791c53a8ull },
+	{ 0xabfa45da0edbde69ull, 0x0487db9d17636892ull }, { 0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull },
+	{ 0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull }, { 0xa7f26836f282b732ull, 0x8e6cac7768d7141eull },
+	{ 0xd1ef0244af2364ffull, 0x3207d795430cd926ull }, { 0x8335616aed761f1full, 0x7f44e6bd49e807b8ull },
+	{ 0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull }, { 0xcd036837130890a1ull, 0x36dba887c37a8c0full },
+	{ 0x802221226be55a64ull, 0xc2494954da2c9789ull }, { 0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull },
+	{ 0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull }, { 0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull },
+	{ 0x9c69a97284b578d7ull, 0xff2a760414536efbull }, { 0xc38413cf25e2d70dull, 0xfef5138519684abaull },
+	{ 0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull }, { 0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull },
+	{ 0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull }, { 0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull },
+	{ 0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull }, { 0xba756174393d88dfull, 0x94f971119aeef9e4ull },
+	{ 0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull }, { 0x91abb422ccb812eeull, 0xac62e055c10ab33aull },
+	{ 0xb616a12b7fe617aaull, 0x577b986b314d6009ull }, { 0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull },
+	{ 0x8e41ade9fbebc27dull, 0x14588f13be847307ull }, { 0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull },
+	{ 0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull }, { 0x8aec23d680043beeull, 0x25de7bb9480d5854ull },
+	{ 0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull }, { 0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull },
+	{ 0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull }, { 0xa99541bf57452b28ull, 0x353a1607ac744a53ull },
+	{ 0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull }, { 0x847c9b5d7c2e09b7ull, 0x69956135febada11ull },
+	{ 0xa59bc234db398c25ull, 0x43fab9837e699095ull }, { 0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull },
+	{ 0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull }, { 0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull },
+	{ 0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull }, { 0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull },
+	{ 0x9defbf01b061adabull, 0x3a0888136afa64a7ull }, { 0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull },
+	{ 0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull }, { 0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull },
+	{ 0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull }, { 0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull },
+	{ 0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull }, { 0xbc4665b596706114ull, 0x873d5d9f0dde1feeull },
+	{ 0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull }, { 0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull },
+	{ 0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full }, { 0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull },
+	{ 0x8fa475791a569d10ull, 0xf96e017d694487bcull }, { 0xb38d92d760ec4455ull, 0x37c981dcc395a9acull },
+	{ 0xe070f78d3927556aull, 0x85bbe253f47b1417ull }, { 0x8c469ab843b89562ull, 0x93956d7478ccec8eull },
+	{ 0xaf58416654a6babbull, 0x387ac8d1970027b2ull }, { 0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull },
+	{ 0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull }, { 0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull },
+	{ 0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull }, { 0x85c7056562757456ull, 0xf6872d5667844e49ull },
+	{ 0xa738c6bebb12d16cull, 0xb428f8ac016561dbull }, { 0xd106f86e69d785c7ull, 0xe13336d701beba52ull },
+	{ 0x82a45b450226b39cull, 0xecc0024661173473ull }, { 0xa34d721642b06084ull, 0x27f002d7f95d0190ull },
+	{ 0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull }, { 0xff290242c83396ceull, 0x7e67047175a15271ull },
+	{ 0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull }, { 0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull },
+	{ 0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull }, { 0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull },
+	{ 0xc2abf989935ddbfeull, 0x6acff893d00ea435ull }, { 0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull },
+	{ 0x98165af37b2153deull, 0xc3727a337a8b704aull }, { 0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull },
+	{ 0xeda2ee1c7064130cull, 0x1162def06f79df73ull }, { 0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull },
+	{ 0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull }, { 0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull },
+	{ 0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull }, { 0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull },
+	{ 0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull }, { 0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull },
+	{ 0xb10d8e1456105dadull, 0x7425a83e872c5f47ull }, { 0xdd50f1996b947518ull, 0xd12f124e28f77719ull },
+	{ 0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full }, { 0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull },
+	{ 0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull }, { 0x8714a775e3e95c78ull, 0x65acfaec34810a71ull },
+	{ 0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull }, { 0xd31045a8341ca07cull, 0x1ede48111209a050ull },
+	{ 0x83ea2b892091e44dull, 0x934aed0aab460432ull }, { 0xa4e4b66b68b65d60ull, 0xf81da84d5617853full },
+	{ 0xce1de40642e3f4b9ull, 0x36251260ab9d668eull }, { 0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull },
+	{ 0xa1075a24e4421730ull, 0xb24cf65b8612f81full }, { 0xc94930ae1d529cfcull, 0xdee033f26797b627ull },
+	{ 0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull }, { 0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull },
+	{ 0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull }, { 0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull },
+	{ 0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull }, { 0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull },
+	{ 0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull }, { 0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull },
+	{ 0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull }, { 0xea53df5fd18d5513ull, 0x84c86189216dc5edull },
+	{ 0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull }, { 0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull },
+	{ 0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull }, { 0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull },
+	{ 0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull }, { 0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull },
+	{ 0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull }, { 0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull },
+	{ 0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull }, { 0x8865899617fb1871ull, 0x7e2fa67c7a658892ull },
+	{ 0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull }, { 0xd51ea6fa85785631ull, 0x552a74227f3ea565ull },
+	{ 0x8533285c936b35deull, 0xd53a88958f87275full }, { 0xa67ff273b8460356ull, 0x8a892abaf368f137ull },
+	{ 0xd01fef10a657842cull, 0x2d2b7569b0432d85ull }, { 0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull },
+	{ 0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full }, { 0xcb3f2f7642717713ull, 0x241c70a936219a73ull },
+	{ 0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull }, { 0x9ec95d1463e8a506ull, 0xf4363804324a40aaull },
+	{ 0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull }, { 0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull },
+	{ 0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull }, { 0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull },
+	{ 0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull }, { 0x976e41088617ca01ull, 0xd5be0503e085d813ull },
+	{ 0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull }, { 0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull },
+	{ 0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull }, { 0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull },
+	{ 0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull }, { 0x906a617d450187e2ull, 0x27fb2b80668b24c5ull },
+	{ 0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull }, { 0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull },
+	{ 0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull }, { 0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull },
+	{ 0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull }, { 0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull },
+	{ 0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull }, { 0xd732290fbacaf133ull, 0xa97c177947ad4095ull },
+	{ 0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull }, { 0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull },
+	{ 0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull }, { 0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull },
+	{ 0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull }, { 0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull },
+	{ 0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull }, { 0xa0555e361951c366ull, 0xd7e105bcc332621full },
+	{ 0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull }, { 0xfa856334878fc150ull, 0xb14f98f6f0feb951ull },
+	{ 0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull }, { 0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull },
+	{ 0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull }, { 0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull },
+	{ 0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull }, { 0xeeea5d5004981478ull, 0x1858ccfce06cac74ull },
+	{ 0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull }, { 0xbaa718e68396cffdull, 0xd30560258f54e6baull },
+	{ 0xe950df20247c83fdull, 0x47c6b82ef32a2069ull }, { 0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull },
+	{ 0xb6472e511c81471dull, 0xe0133fe4adf8e952ull }, { 0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull },
+	{ 0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull }
+};
+
+// The 128-bit product a * b: returns the low 64 bits & sets *high.
+static uint64_t ezi_num_mul(uint64_t a, uint64_t b, uint64_t *high)
+{
+#if defined(__SIZEOF_INT128__)
+	unsigned __int128 r = (unsigned __int128)a * b;
+
+	*high = (uint64_t)(r >> 64);
+	return (uint64_t)r;
+#else
+	uint64_t ll  = (a & 0xffffffffull) * (b & 0xffffffffull);
+	uint64_t lh  = (a & 0xffffffffull) * (b >> 32);
+	uint64_t hl  = (a >> 32) * (b & 0xffffffffull);
+	uint64_t mid = (ll >> 32) + (lh & 0xffffffffull) + (hl & 0xffffffffull);
+
+	*high = (a >> 32) * (b >> 32) + (lh >> 32) + (hl >> 32) + (mid >> 32);
+	return (mid << 32) | (ll & 0xffffffffull);
+#endif
+}
+
+// w * 10^q, correctly rounded, for any nonzero w (Eisel & Lemire).  w is normalised so that its top
+// bit is set; the product with 5^q then has the double's 53 bits, a rounding bit and 2 spare at the
+// top, and only if the 9 bits below those are all ones could the rest of 5^q carry into them.
+static double ezi_num_lemire(uint64_t w, int64_t q)
+{
+	const uint64_t *pow5;
+	uint64_t        high, low, high2, mant, bits;
+	int             lz = 0, upper, shift, power2;
+	double          d;
+
+	if ( q < EZI_NUM_POW5_MIN )
+		return 0.0;
+	if ( q > EZI_NUM_POW5_MAX )
+		return HUGE_VAL;
+	pow5 = ezi_pow5_128[q - EZI_NUM_POW5_MIN];
+
+#if defined(__GNUC__)
+	lz = __builtin_clzll(w);
+#else
+	while ( (w << lz) >> 63 == 0ull )
+		lz++;
+#endif
+	w  <<= lz;
+	low  = ezi_num_mul(w, pow5[0], &high);
+	if ( (high & 0x1ffull) == 0x1ffull )
+	{
+		ezi_num_mul(w, pow5[1], &high2);
+		low  += high2;
+		high += low < high2;
+	}
+
+	upper  = (int)(high >> 63);
+	shift  = upper + 64 - 52 - 3;
+	mant   = high >> shift;
+	power2 = ((217706 * (int)q) >> 16) + 63 + upper - lz + 1023;  // 217706 / 2^16: log2(10).
+
+	if ( power2 <= 0 )  // Subnormal (or 0): if it rounds up to the smallest normal, the bits are the same.
+	{
+		bits = 0ull;
+		if ( 1 - power2 < 64 )
+		{
+			mant >>= 1 - power2;
+			bits   = (mant + (mant & 1ull)) >> 1;
+		}
+	}
+	else
+	{
+		// Exactly halfway, which only small powers can be: round to even, i.e. down.
+		if ( low <= 1ull && q >= -4 && q <= 23 && (mant & 3ull) == 1ull && (mant << shift) == high )
+			mant &= ~1ull;
+		mant = (mant + (mant & 1ull)) >> 1;
+		if ( mant >= (2ull << 52) )  // Rounded up to the next power of 2.
+		{
+			mant = 1ull << 52;
+			power2++;
+		}
+		bits = ( power2 >= 0x7ff ) ? 0x7ffull << 52 : (mant & ~(1ull << 52)) | ((uint64_t)power2 << 52);
+	}
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+// Converts 8 ASCII digits at p, if they are all digits: returns 1 & sets *value, else 0.
+static int ezi_num_eight(const char *p, uint64_t *value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	uint64_t v;
+
+	memcpy(&v, p, 8);
+	if ( (((v & 0xf0f0f0f0f0f0f0f0ull) | (((v + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4))
+	      != 0x3333333333333333ull) )
+		return 0;
+
+	v -= 0x3030303030303030ull;
+	v  = (v * 10ull) + (v >> 8);  // Pairs of digits ...
+	v  = (((v & 0x000000ff000000ffull) * (100ull + (1000000ull << 32)))
+	    + (((v >> 16) & 0x000000ff000000ffull) * (1ull + (10000ull << 32)))) >> 32;  // ... then all 8.
+	*value = v;
+	return 1;
+#else
+	(void)p; (void)value;
+	return 0;
+#endif
+}
+
+// Unsigned decimal digits: returns the number of characters used (0 if none).  Sets *overflow.
+static size_t ezi_num_digits(const char *p, size_t len, uint64_t *value, int *overflow)
+{
+	uint64_t v = 0ull, eight;
+	size_t   i = 0ul;
+	unsigned d;
+
+	*overflow = 0;
+	while ( i + 8ul <= len && v < 100000000000ull && ezi_num_eight(&p[i], &eight) )  // Can't overflow.
+	{
+		v  = v * 100000000ull + eight;
+		i += 8ul;
+	}
+
+	for ( ; i < len && (d = (unsigned)(p[i] - '0')) <= 9u; i++ )
+	{
+		if ( v > (UINT64_MAX - d) / 10ull )
+			*overflow = 1;
+		else
+			v = v * 10ull + d;
+	}
+
+	*value = *overflow ? UINT64_MAX : v;
+	return i;
+}
+
+static int ezi_num_result(int overflow, size_t used, size_t len)
+{
+	if ( overflow )
+		return EZI_NUM_OVERFLOW;
+	return ( used < len ) ? EZI_NUM_TRAILING : EZI_NUM_OK;
+}
+
+// Clamps the field to the string: returns it as a view.
+static EZI_VIEW_T ezi_num_field(EZI_STR_T *buf, size_t offset, size_t len)
+{
+	EZI_VIEW_T view = { NULL, 0ul };
+
+	if ( buf != NULL && offset <= buf->len )
+	{
+		view.str = &buf->str[offset];
+		view.len = MIN(len, buf->len - offset);
+	}
+	return view;
+}
+
+int ezi_view_to_u64(EZI_VIEW_T view, uint64_t *value)
+{
+	size_t sign = ( view.len > 0ul && view.str[0] == '+' ) ? 1ul : 0ul;
+	size_t used;
+	int    overflow;
+
+	used = ezi_num_digits(&view.str[sign], view.len - sign, value, &overflow);
+	if ( used == 0ul )
+	{
+		*value = 0ull;
+		return EZI_NUM_EMPTY;
+	}
+	return ezi_num_result(overflow, sign + used, view.len);
+}
+
+int ezi_view_to_i64(EZI_VIEW_T view, int64_t *value)
+{
+	int      negative = view.len > 0ul && view.str[0] == '-';
+	size_t   sign     = ( view.len > 0ul && (view.str[0] == '-' || view.str[0] == '+') ) ? 1ul : 0ul;
+	uint64_t limit    = negative ? (uint64_t)INT64_MAX + 1ull : (uint64_t)INT64_MAX;
+	uint64_t magnitude;
+	size_t   used;
+	int      overflow;
+
+	used = ezi_num_digits(&view.str[sign], view.len - sign, &magnitude, &overflow);
+	if ( used == 0ul )
+	{
+		*value = 0;
+		return EZI_NUM_EMPTY;
+	}
+	if ( magnitude > limit )
+	{
+		overflow  = 1;
+		magnitude = limit;
+	}
+	*value = negative ? (int64_t)(0ull - magnitude) : (int64_t)magnitude;  // -(2^63) wraps to INT64_MIN.
+	return ezi_num_result(overflow, sign + used, view.len);
+}
+
+int ezi_view_to_hex_u32(EZI_VIEW_T view, uint32_t *value)
+{
+	size_t   i = 0ul, start;
+	uint32_t v = 0u;
+	int      overflow = 0, d;
+
+	if ( view.len > 2ul && view.str[0] == '0' && (view.str[1] == 'x' || view.str[1] == 'X')
+	  && ((view.str[2] >= '0' && view.str[2] <= '9') || ((view.str[2] | 0x20) >= 'a' && (view.str[2] | 0x20) <= 'f')) )
+		i = 2ul;
+
+	for ( start = i; i < view.len; i++ )
+	{
+		char c = view.str[i];
+
+		if      ( c >= '0' && c <= '9' ) d = c - '0';
+		else if ( c >= 'a' && c <= 'f' ) d = c - 'a' + 10;
+		else if ( c >= 'A' && c <= 'F' ) d = c - 'A' + 10;
+		else break;
+
+		if ( v > 0x0fffffffu )
+			overflow = 1;
+		else
+			v = (v << 4) | (uint32_t)d;
+	}
+
+	*value = overflow ? UINT32_MAX : v;
+	if ( i == start )
+		return EZI_NUM_EMPTY;
+	return ezi_num_result(overflow, i, view.len);
+}
+
+// Case-insensitive match of 'word' at the start of the view.
+static int ezi_num_word(EZI_VIEW_T view, size_t at, const char *word)
+{
+	size_t n = strlen(word), i;
+
+	if ( view.len - at < n )
+		return 0;
+	for ( i = 0ul; i < n; i++ )
+	{
+		if ( (view.str[at + i] | 0x20) != word[i] )
+			return 0;
+	}
+	return 1;
+}
+
+// Number of decimal digits at p (up to len), 8 at a time where possible.
+static size_t ezi_num_span(const char *p, size_t len)
+{
+	uint64_t eight;
+	size_t   i = 0ul;
+
+	while ( i + 8ul <= len && ezi_num_eight(&p[i], &eight) )
+		i += 8ul;
+	while ( i < len && p[i] >= '0' && p[i] <= '9' )
+		i++;
+	return i;
+}
+
+/* The slow path of ezi_num_long(): the significant digits of int_part & frac_part (at most
+EZI_NUM_SLOW_MAX, then a sticky '1' if anything nonzero was dropped) and an exponent, for strtod(). */
+static double ezi_num_strtod(const char *int_part, size_t int_len, const char *frac_part, size_t frac_len, int64_t exp10)
+{
+	char   text[EZI_NUM_SLOW_MAX + 32];
+	size_t n = 0ul, k;
+	int    sticky = 0;
+
+	for ( k = 0ul; k < int_len + frac_len; k++ )
+	{
+		int  fraction = k >= int_len;
+		char c        = fraction ? frac_part[k - int_len] : int_part[k];
+
+		if ( n == 0ul && c == '0' )
+			exp10 -= fraction;      // Leading zero.
+		else if ( n < EZI_NUM_SLOW_MAX )
+		{
+			text[n++] = c;
+			exp10    -= fraction;
+		}
+		else
+		{
+			sticky |= c != '0';     // Dropped digit.
+			exp10  += !fraction;
+		}
+	}
+	if ( n == 0ul )
+		return 0.0;
+	if ( sticky )
+	{
+		text[n++] = '1';
+		exp10--;
+	}
+	snprintf(&text[n], sizeof(text) - n, "e%lld", (long long)exp10);
+	return strtod(text, NULL);
+}
+
+/* More than EZI_NUM_SIG_MAX digits: the first EZI_NUM_SIG_MAX significant digits, w, at w & w+1.
+If those don't round to the same double, ezi_num_strtod() decides. */
+static double ezi_num_long(const char *int_part, size_t int_len, const char *frac_part, size_t frac_len, int64_t exp10)
+{
+	uint64_t w = 0ull;
+	size_t   n = 0ul, k;
+	int64_t  q = exp10;
+	int      sticky = 0;
+	double   d;
+
+	for ( k = 0ul; k < int_len + frac_len; k++ )
+	{
+		int  fraction = k >= int_len;
+		char c        = fraction ? frac_part[k - int_len] : int_part[k];
+
+		if ( n == 0ul && c == '0' )
+			q -= fraction;          // Leading zero.
+		else if ( n < EZI_NUM_SIG_MAX )
+		{
+			w  = w * 10ull + (uint64_t)(c - '0');
+			q -= fraction;
+			n++;
+		}
+		else
+		{
+			sticky |= c != '0';     // Dropped digit.
+			q      += !fraction;
+		}
+	}
+	if ( n == 0ul )
+		return 0.0;
+
+	d = ezi_num_lemire(w, q);
+	if ( sticky && ezi_num_lemire(w + 1ull, q) != d )
+		d = ezi_num_strtod(int_part, int_len, frac_part, frac_len, exp10);
+	return d;
+}
+
+int ezi_view_to_double(EZI_VIEW_T view, double *value)
+{
+	const char *p        = view.str;
+	size_t      len      = view.len;
+	size_t      i        = 0ul, e, int_at, int_len, frac_at = 0ul, frac_len = 0ul;
+	int         negative = 0, esign = 1, overflow;
+	int64_t     exp10    = 0, written = 0;
+	uint64_t    mant, frac;
+	double      d;
+
+	if ( i < len && (p[i] == '-' || p[i] == '+') )
+		negative = p[i++] == '-';
+
+	if ( ezi_num_word(view, i, "inf") || ezi_num_word(view, i, "nan") )
+	{
+		d  = ( (p[i] | 0x20) == 'n' ) ? NAN : HUGE_VAL;
+		i += ( isinf(d) && ezi_num_word(view, i, "infinity") ) ? 8ul : 3ul;
+		*value = negative ? -d : d;
+		return ezi_num_result(0, i, len);
+	}
+
+	int_at  = i;
+	int_len = ezi_num_span(&p[i], len - i);
+	i      += int_len;
+	if ( i < len && p[i] == '.' )
+	{
+		frac_at  = i + 1ul;
+		frac_len = ezi_num_span(&p[frac_at], len - frac_at);
+		if ( int_len > 0ul || frac_len > 0ul )
+			i = frac_at + frac_len;
+	}
+	if ( int_len == 0ul && frac_len == 0ul )
+	{
+		*value = 0.0;
+		return EZI_NUM_EMPTY;
+	}
+
+	// Exponent: only if it has digits, otherwise the 'e' is trailing.
+	if ( i < len && (p[i] == 'e' || p[i] == 'E') )
+	{
+		e = i + 1ul;
+		if ( e < len && (p[e] == '-' || p[e] == '+') )
+			esign = ( p[e++] == '-' ) ? -1 : 1;
+		if ( e < len && p[e] >= '0' && p[e] <= '9' )
+		{
+			for ( ; e < len && p[e] >= '0' && p[e] <= '9'; e++ )
+			{
+				if ( written < 100000000 )  // Far beyond any double: saturate.
+					written = written * 10 + (p[e] - '0');
+			}
+			i = e;
+		}
+	}
+	written *= esign;
+
+	if ( int_len + frac_len <= EZI_NUM_SIG_MAX )  // The usual case: the digits fit in a uint64_t.
+	{
+		ezi_num_digits(&p[int_at], int_len, &mant, &overflow);
+		ezi_num_digits(&p[frac_at], frac_len, &frac, &overflow);
+		for ( e = 0ul; e < frac_len; e++ )
+			mant *= 10ull;
+		mant += frac;
+		exp10 = written - (int64_t)frac_len;
+
+		if ( exp10 > 22 && exp10 <= 22 + 15 && mant <= (1ull << 53) )
+		{
+			for ( ; exp10 > 22 && mant <= (1ull << 53) / 10ull; exp10-- )  // Move the excess into mant, exactly.
+				mant *= 10ull;
+		}
+
+		if ( mant == 0ull )
+			d = 0.0;
+		else if ( mant <= (1ull << 53) && exp10 >= -22 && exp10 <= 22 )
+			d = ( exp10 < 0 ) ? (double)mant / ezi_pow10[-exp10] : (double)mant * ezi_pow10[exp10];
+		else
+			d = ezi_num_lemire(mant, exp10);
+	}
+	else
+		d = ezi_num_long(&p[int_at], int_len, &p[frac_at], frac_len, written);
+
+	if ( isinf(d) )
+	{
+		*value = negative ? -HUGE_VAL : HUGE_VAL;
+		return EZI_NUM_OVERFLOW;
+	}
+	*value = negative ? -d : d;
+	return ezi_num_result(0, i, len);
+}
+
+int ezi_to_u64(EZI_STR_T *buf, size_t offset, size_t len, uint64_t *value)
+{
+	return ezi_view_to_u64(ezi_num_field(buf, offset, len), value);
+}
+
+int ezi_to_i64(EZI_STR_T *buf, size_t offset, size_t len, int64_t *value)
+{
+	return ezi_view_to_i64(ezi_num_field(buf, offset, len), value);
+}
+
+int ezi_to_double(EZI_STR_T *buf, size_t offset, size_t len, double *value)
+{
+	return ezi_view_to_double(ezi_num_field(buf, offset, len), value);
+}
+
+int ezi_hex_to_u32(EZI_STR_T *buf, size_t offset, size_t len, uint32_t *value)
+{
+	return ezi_view_to_hex_u32(ezi_num_field(buf, offset, len), value);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Packed string table.
+
+All the strings live one after another in one 'data' block, each followed by a '\0', and string
+i is data[offset[i] .. offset[i+1] - 1).  So there is no per-string malloc() or Ezi header, and
+looking up string i is two loads.  Strings are only ever appended.
+
+The file written by ezi_strtab_save() is the same layout with a header in front, so that
+ezi_strtab_load() can mmap() it and use it straight away: nothing is parsed or copied, and the
+pages are only read in as they are used.  The file format (all integers in the writer's byte
+order, which the endian tag checks) is:
+
+	offset  size
+	0       8    magic "EZISTRTB"
+	8       4    version (1)
+	12      4    endian tag 0x01020304
+	16      4    flags (0: readers must reject flags they don't know)
+	20      4    header size (64)
+	24      8    count
+	32      8    offset of the index: count + 1 uint64_t's
+	40      8    offset of the data
+	48      8    size of the data
+	56      8    offset of the symbol table if flags has EZI_STRTAB_COMPRESSED, else 0
+
+A loaded table is read-only: ezi_strtab_add() refuses it.  Lookups check each string's offsets
+against the data size, and a plain string's '\0', so a damaged file gives empty strings rather
+than wild reads or unterminated ones.  The index is read in place, so an image given to
+ezi_strtab_from_image() must be 8-byte aligned, as mmap()'d & malloc()'d memory is.
+
+A compressed table (see ezi_strtab_compress() below) stores each string as codes instead, with no
+'\0', and saves its symbol table as a uint64_t count, 255 uint64_t symbols and 256 lengths. */
+
+#define EZI_STRTAB_MAGIC   "EZISTRTB"
+#define EZI_STRTAB_VERSION 1u
+#define EZI_STRTAB_ENDIAN  0x01020304u
+#define EZI_STRTAB_HEADER  64u
+#define EZI_STRTAB_COMPRESSED 1u
+
+typedef struct
+{
+	char     magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint32_t flags;
+	uint32_t header_size;
+	uint64_t count;
+	uint64_t index_at;
+	uint64_t data_at;
+	uint64_t data_size;
+	uint64_t symtab_at;
+} EZI_STRTAB_FILE_T;
+
+/* Symbol table of a compressed string table.
+
+Like FSST (Boncz, Neumann & Leis, "FSST: fast random access string compression"): each string is
+coded on its own as a sequence of byte codes, code c < 255 standing for the 1 to 8 bytes of
+sym[c], and code 255 (EZI_SYMTAB_ESC) being followed by one literal byte.  So decoding is a table
+lookup and one 8-byte store per code, and any string can be decoded without its neighbours.
+
+The symbols are trained on a sample of the strings: each round codes the sample with the current
+symbols, counts how often each symbol (or literal byte) occurs and how often each pair occurs
+next to each other, and keeps the 255 symbols or joined pairs that would save the most bytes.
+
+The coder takes the longest symbol that matches at each place, looking only at the symbols that
+start with that byte, longest first. */
+
+#define EZI_SYMTAB_ESC    255u
+#define EZI_SYMTAB_ROUNDS 5
+#define EZI_SYMTAB_SAMPLE (32ul * 1024ul)
+#define EZI_SYMTAB_SAVED  (8ul + 255ul * 8ul + 256ul)
+
+struct ezi_symtab_struct_tag
+{
+	uint64_t count;
+	uint64_t sym[255];    // Bytes in memory order, unused bytes 0.  count, sym & len are saved.
+	uint8_t  len[256];
+	uint64_t mask[9];     // mask[n] keeps the first n bytes of a symbol.
+	uint16_t first[257];  // Codes starting with byte b are order[first[b] .. first[b+1]).
+	uint8_t  order[255];
+};
+
+typedef struct
+{
+	uint64_t sym;
+	uint64_t gain;
+	uint32_t len;
+} EZI_SYMTAB_CAND_T;
+
+static unsigned ezi_symtab_first(uint64_t sym)
+{
+	return *(uint8_t *)&sym;
+}
+
+// Builds mask[] & the lookup order once count, sym[] & len[] are set.
+static void ezi_symtab_index(EZI_SYMTAB_T *st)
+{
+	unsigned at[256] = { 0 };
+	unsigned c, b, n;
+
+	for ( n = 0; n <= 8; n++ )
+	{
+		uint8_t bytes[8] = { 0 };
+
+		memset(bytes, 0xff, n);
+		memcpy(&st->mask[n], bytes, 8);
+	}
+
+	memset(st->first, 0, sizeof(st->first));
+	for ( c = 0; c < st->count; c++ )
+		st->first[ezi_symtab_first(st->sym[c]) + 1]++;
+	for ( b = 0; b < 256; b++ )
+		st->first[b + 1] += st->first[b];
+
+	// Longest first within each first byte: a counting sort by length, from 8 down.
+	for ( n = 8; n > 0; n-- )
+		for ( c = 0; c < st->count; c++ )
+			if ( st->len[c] == n )
+			{
+				b = ezi_symtab_first(st->sym[c]);
+				st->order[st->first[b] + at[b]++] = (uint8_t)c;
+			}
+}
+
+// Length of the longest symbol at 'in', and its code in *code; 0 if none (so escape).
+static size_t ezi_symtab_match(EZI_SYMTAB_T *st, const uint8_t *in, size_t in_len, unsigned *code)
+{
+	uint64_t word = 0ull;
+	unsigned i, end;
+
+	memcpy(&word, in, MIN(in_len, 8ul));
+	for ( i = st->first[in[0]], end = st->first[in[0] + 1]; i < end; i++ )
+	{
+		unsigned c = st->order[i];
+
+		if ( st->len[c] <= in_len && ((word ^ st->sym[c]) & st->mask[st->len[c]]) == 0ull )
+		{
+			*code = c;
+			return st->len[c];
+		}
+	}
+	return 0ul;
+}
+
+// Codes in[] into out[], which must have room for 2 * in_len.  Returns the coded length.
+static size_t ezi_symtab_encode(EZI_SYMTAB_T *st, const uint8_t *in, size_t in_len, uint8_t *out)
+{
+	uint8_t *start = out;
+	size_t   at = 0ul;
+
+	while ( at < in_len )
+	{
+		unsigned code;
+		size_t   n = ezi_symtab_match(st, &in[at], in_len - at, &code);
+
+		if ( n > 0ul )
+			*out++ = (uint8_t)code;
+		else
+		{
+			*out++ = EZI_SYMTAB_ESC;
+			*out++ = in[at];
+			n = 1ul;
+		}
+		at += n;
+	}
+	return (size_t)(out - start);
+}
+
+// Decodes in[] into out[0 .. max), stopping when that is full.  Sets *cut if it had to stop.
+static size_t ezi_symtab_decode(EZI_SYMTAB_T *st, const uint8_t *in, size_t in_len, char *out, size_t max, int *cut)
+{
+	const uint8_t *end = in + in_len;
+	char          *at = out;
+
+	// Whole 8-byte stores while they fit: the bytes past the symbol get overwritten next.
+	while ( in < end && (size_t)(at - out) + 8ul <= max )
+	{
+		unsigned code = *in++;
+
+		if ( code != EZI_SYMTAB_ESC )
+		{
+			memcpy(at, &st->sym[code], 8);
+			at += st->len[code];
+		}
+		else if ( in < end )
+			*at++ = (char)*in++;
+	}
+
+	while ( in < end )
+	{
+		unsigned    code = *in++;
+		const char *sym;
+		size_t      n;
+
+		if ( code != EZI_SYMTAB_ESC )
+		{
+			sym = (const char *)&st->sym[code];
+			n   = st->len[code];
+		}
+		else if ( in < end )
+		{
+			sym = (const char *)in++;
+			n   = 1ul;
+		}
+		else
+			break;
+		if ( n > max - (size_t)(at - out) )
+		{
+			n = max - (size_t)(at - out);
+			memcpy(at, sym, n);
+			at += n;
+			*cut = 1;
+			break;
+		}
+		memcpy(at, sym, n);
+		at += n;
+	}
+	return (size_t)(at - out);
+}
+
+static int ezi_symtab_cand_sym_cmp(const void *a, const void *b)
+{
+	const EZI_SYMTAB_CAND_T *ca = a, *cb = b;
+
+	if ( ca->len != cb->len )
+		return ca->len < cb->len ? -1 : 1;
+	return ca->sym < cb->sym ? -1 : ca->sym > cb->sym;
+}
+
+static int ezi_symtab_cand_gain_cmp(const void *a, const void *b)
+{
+	const EZI_SYMTAB_CAND_T *ca = a, *cb = b;
+
+	if ( ca->gain != cb->gain )
+		return ca->gain > cb->gain ? -1 : 1;
+	return ezi_symtab_cand_sym_cmp(a, b);
+}
+
+// Trains a symbol table on a sample of up to EZI_SYMTAB_SAMPLE bytes of 'from'.  NULL if out of memory.
+static EZI_SYMTAB_T *ezi_symtab_train(EZI_STRTAB_T *from)
+{
+	EZI_SYMTAB_T      *st     = calloc(1, sizeof(EZI_SYMTAB_T));
+	uint32_t          *count1 = calloc(512, sizeof(uint32_t));
+	uint32_t          *count2 = calloc(512ul * 512ul, sizeof(uint32_t));  // Pseudo-codes 256 + b are literals.
+	EZI_SYMTAB_CAND_T *cand   = NULL;
+	size_t             step   = from->data_size / EZI_SYMTAB_SAMPLE + 1ul;
+	size_t             max_cand, round, i;
+
+	// At most 512 symbols & literals, and a pair per token of the sample: at least a byte each.
+	max_cand = 512ul + MIN(from->data_size, EZI_SYMTAB_SAMPLE);
+	if ( st == NULL || count1 == NULL || count2 == NULL
+	  || (cand = malloc(max_cand * sizeof(EZI_SYMTAB_CAND_T))) == NULL )
+	{
+		free(st);
+		st = NULL;
+		goto done;
+	}
+	ezi_symtab_index(st);
+
+	for ( round = 0; round < EZI_SYMTAB_ROUNDS; round++ )
+	{
+		size_t   n_cand = 0ul, sampled = 0ul, j;
+		unsigned c, d;
+
+		memset(count1, 0, 512 * sizeof(uint32_t));
+		memset(count2, 0, 512ul * 512ul * sizeof(uint32_t));
+
+		// Every step'th string, until the sample is full: the last one is cut short to fit.
+		for ( i = 0; i < from->count && sampled < EZI_SYMTAB_SAMPLE; i += step )
+		{
+			EZI_VIEW_T     view = ezi_strtab_get(from, i);
+			const uint8_t *in   = (const uint8_t *)view.str;
+			size_t         len  = MIN(view.len, EZI_SYMTAB_SAMPLE - sampled), at = 0ul;
+			unsigned       prev = 512;
+
+			sampled += len;
+			while ( at < len )
+			{
+				size_t n = ezi_symtab_match(st, &in[at], len - at, &c);
+
+				if ( n == 0ul )
+				{
+					c = 256u + in[at];
+					n = 1ul;
+				}
+				count1[c]++;
+				if ( prev < 512 )
+					count2[prev * 512u + c]++;
+				prev = c;
+				at += n;
+			}
+		}
+
+		// Candidates: every symbol & literal seen, and every pair seen that fits in 8 bytes.
+		for ( c = 0; c < 512; c++ )
+		{
+			uint64_t sym_c;
+			unsigned len_c;
+
+			if ( count1[c] == 0 || n_cand >= max_cand )
+				continue;
+			sym_c = c < EZI_SYMTAB_ESC ? st->sym[c] : 0ull;
+			len_c = c < EZI_SYMTAB_ESC ? st->len[c] : 1u;
+			if ( c >= 256 )
+				*(uint8_t *)&sym_c = (uint8_t)(c - 256u);
+			cand[n_cand].sym  = sym_c;
+			cand[n_cand].len  = len_c;
+			cand[n_cand].gain = (uint64_t)count1[c] * len_c;
+			n_cand++;
+
+			for ( d = 0; d < 512 && n_cand < max_cand; d++ )
+			{
+				uint8_t  bytes[16] = { 0 };
+				uint64_t sym_d = d < EZI_SYMTAB_ESC ? st->sym[d] : 0ull;
+				unsigned len_d = d < EZI_SYMTAB_ESC ? st->len[d] : 1u;
+
+				if ( count2[c * 512u + d] == 0 || len_c + len_d > 8 )
+					continue;
+				if ( d >= 256 )
+					*(uint8_t *)&sym_d = (uint8_t)(d - 256u);
+				memcpy(bytes, &sym_c, 8);
+				memcpy(&bytes[len_c], &sym_d, 8);
+				memcpy(&cand[n_cand].sym, bytes, 8);
+				cand[n_cand].len  = len_c + len_d;
+				cand[n_cand].gain = (uint64_t)count2[c * 512u + d] * (len_c + len_d);
+				n_cand++;
+			}
+		}
+
+		// Add up the gains of the same bytes found more than one way, then keep the best 255.
+		qsort(cand, n_cand, sizeof(EZI_SYMTAB_CAND_T), ezi_symtab_cand_sym_cmp);
+		for ( i = 0, j = 0; i < n_cand; i++ )
+		{
+			if ( j > 0 && cand[j - 1].len == cand[i].len && cand[j - 1].sym == cand[i].sym )
+				cand[j - 1].gain += cand[i].gain;
+			else
+				cand[j++] = cand[i];
+		}
+		n_cand = j;
+		qsort(cand, n_cand, sizeof(EZI_SYMTAB_CAND_T), ezi_symtab_cand_gain_cmp);
+
+		memset(st->len, 0, sizeof(st->len));
+		memset(st->sym, 0, sizeof(st->sym));
+		st->count = MIN(n_cand, 255ul);
+		for ( i = 0; i < st->count; i++ )
+		{
+			st->sym[i] = cand[i].sym;
+			st->len[i] = (uint8_t)cand[i].len;
+		}
+		ezi_symtab_index(st);
+	}
+
+done:
+	free(cand);
+	free(count2);
+	free(count1);
+	return st;
+}
+
+EZI_STRTAB_T *ezi_strtab_init(EZI_STRTAB_T *tab)
+{
+#ifndef MEMORY_CONFIDENCE
+	if ( tab == NULL )
+		return NULL;
+#endif
+
+	memset(tab, 0, sizeof(*tab));
+	return tab;
+}
+
+void ezi_strtab_free(EZI_STRTAB_T *tab)
+{
+	if ( tab == NULL )
+		return;
+
+	free(tab->symtab);
+	if ( tab->image == NULL )
+	{
+		free(tab->data);
+		free(tab->offset);
+	}
+#ifdef EZI_POSIX
+	else if ( tab->mapped )
+		munmap(tab->image, tab->image_size);
+#endif
+	else if ( tab->owned )
+		free(tab->image);
+
+	ezi_strtab_init(tab);
+}
+
+size_t ezi_strtab_count(EZI_STRTAB_T *tab)
+{
+	return tab ? tab->count : 0ul;
+}
+
+size_t ezi_strtab_add_raw(EZI_STRTAB_T *tab, char *from, size_t from_len)
+{
+	size_t need;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( tab == NULL || (from == NULL && from_len > 0ul) )
+		return EZI_STRTAB_FAIL;
+#endif
+
+	if ( tab->image != NULL )
+		return EZI_STRTAB_FAIL;  // Loaded tables are read-only.
+
+	if ( tab->count + 2ul > tab->index_cap )
+	{
+		size_t    cap = MAX(64ul, tab->index_cap * 2ul);
+		uint64_t *offset = realloc(tab->offset, cap * sizeof(uint64_t));
+
+		if ( offset == NULL )
+			return EZI_STRTAB_FAIL;
+		offset[0]      = 0ull;
+		tab->offset    = offset;
+		tab->index_cap = cap;
+	}
+
+	// Room for the worst case: coding can double the length.
+	need = tab->data_size + (tab->symtab ? from_len * 2ul : from_len + 1ul);
+	if ( need > tab->data_cap )
+	{
+		size_t cap  = MAX(MAX(4096ul, tab->data_cap * 2ul), need);
+		char  *data = realloc(tab->data, cap);
+
+		if ( data == NULL )
+			return EZI_STRTAB_FAIL;
+		tab->data     = data;
+		tab->data_cap = cap;
+	}
+
+	if ( tab->symtab != NULL )
+		tab->data_size += ezi_symtab_encode(tab->symtab, (uint8_t *)from, from_len, (uint8_t *)&tab->data[tab->data_size]);
+	else
+	{
+		memcpy(&tab->data[tab->data_size], from, from_len);
+		tab->data[tab->data_size + from_len] = '\0';
+		tab->data_size = need;
+	}
+	tab->offset[++tab->count] = (uint64_t)tab->data_size;
+	return tab->count - 1ul;
+}
+
+size_t ezi_strtab_add(EZI_STRTAB_T *tab, EZI_STR_T *from)
+{
+	return ezi_strtab_add_raw(tab, from->str, from->len);
+}
+
+// Stored bytes of entry i, without a plain table's '\0': {NULL, 0} if out of range or damaged.
+static EZI_VIEW_T ezi_strtab_stored(EZI_STRTAB_T *tab, size_t i)
+{
+	EZI_VIEW_T view = { NULL, 0ul };
+
+	if ( tab != NULL && i < tab->count )
+	{
+		uint64_t begin = tab->offset[i];
+		uint64_t end   = tab->offset[i + 1ul];
+		uint64_t nul   = tab->symtab ? 0ull : 1ull;
+
+		if ( begin + nul <= end && end <= tab->data_size && (nul == 0ull || tab->data[end - 1ull] == '\0') )
+		{
+			view.str = &tab->data[begin];
+			view.len = (size_t)(end - begin - nul);
+		}
+	}
+	return view;
+}
+
+EZI_VIEW_T ezi_strtab_get(EZI_STRTAB_T *tab, size_t i)
+{
+	EZI_VIEW_T none = { NULL, 0ul };
+
+	return ( tab != NULL && tab->symtab != NULL ) ? none : ezi_strtab_stored(tab, i);
+}
+
+EZI_STR_T *ezi_strtab_cpy(EZI_STR_T *to, EZI_STRTAB_T *tab, size_t i)
+{
+	EZI_VIEW_T view = ezi_strtab_stored(tab, i);
+	int        cut  = 0;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL )
+		return NULL;
+#endif
+
+	if ( view.str != NULL && tab->symtab != NULL )
+		to->len = ezi_symtab_decode(tab->symtab, (uint8_t *)view.str, view.len, to->str, to->max, &cut);
+	else
+	{
+		to->len = MIN(view.len, to->max);
+		memcpy(to->str, view.str ? view.str : "", to->len);
+		cut = view.len > to->max;
+	}
+	to->str[to->len] = '\0';
+#ifdef EZI_UTF8
+	if ( cut )
+		ezi_utf8_backoff(to, 0ul);
+#else
+	(void)cut;
+#endif
+	return to;
+}
+
+/* Compressed tables.  ezi_strtab_compress() trains a symbol table on 'from' and codes each of its
+strings into 'to', which is then used like any other table but through ezi_strtab_cpy() rather
+than ezi_strtab_get().  Strings added to 'to' later are coded with the same symbols.
+
+Because the coder is deterministic, two strings are equal if and only if their codes are, so
+ezi_strtab_eq() codes the probe as it goes and compares codes, never decoding the entry.
+ezi_strtab_prefix() can't do that (the symbols may straddle the end of the prefix) so it decodes
+symbol by symbol only as far as the prefix goes. */
+
+int ezi_strtab_compress(EZI_STRTAB_T *to, EZI_STRTAB_T *from)
+{
+	size_t i;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL || from == NULL )
+		return -1;
+#endif
+
+	if ( from->symtab != NULL )
+		return -1;  // Already compressed.
+	ezi_strtab_init(to);
+	if ( (to->symtab = ezi_symtab_train(from)) == NULL )
+		return -1;
+
+	for ( i = 0; i < from->count; i++ )
+	{
+		EZI_VIEW_T view = ezi_strtab_get(from, i);
+
+		if ( ezi_strtab_add_raw(to, view.str, view.len) == EZI_STRTAB_FAIL )
+		{
+			ezi_strtab_free(to);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int ezi_strtab_eq_raw(EZI_STRTAB_T *tab, size_t i, char *probe, size_t probe_len)
+{
+	EZI_VIEW_T     view = ezi_strtab_stored(tab, i);
+	const uint8_t *in   = (const uint8_t *)probe;
+	const uint8_t *code = (const uint8_t *)view.str;
+	size_t         at = 0ul, k = 0ul;
+
+	if ( view.str == NULL )
+		return 0;
+	if ( tab->symtab == NULL )
+		return view.len == probe_len && memcmp(view.str, probe, probe_len) == 0;
+
+	while ( at < probe_len )
+	{
+		unsigned c;
+		size_t   n = ezi_symtab_match(tab->symtab, &in[at], probe_len - at, &c);
+
+		if ( n > 0ul )
+		{
+			if ( k >= view.len || code[k] != c )
+				return 0;
+			k++;
+		}
+		else
+		{
+			if ( k + 1ul >= view.len || code[k] != EZI_SYMTAB_ESC || code[k + 1ul] != in[at] )
+				return 0;
+			k += 2ul;
+			n = 1ul;
+		}
+		at += n;
+	}
+	return k == view.len;
+}
+
+int ezi_strtab_eq(EZI_STRTAB_T *tab, size_t i, EZI_STR_T *probe)
+{
+	return ezi_strtab_eq_raw(tab, i, probe->str, probe->len);
+}
+
+int ezi_strtab_prefix_raw(EZI_STRTAB_T *tab, size_t i, char *prefix, size_t prefix_len)
+{
+	EZI_VIEW_T     view = ezi_strtab_stored(tab, i);
+	const uint8_t *code = (const uint8_t *)view.str;
+	size_t         at = 0ul, k = 0ul;
+
+	if ( view.str == NULL )
+		return 0;
+	if ( tab->symtab == NULL )
+		return view.len >= prefix_len && memcmp(view.str, prefix, prefix_len) == 0;
+
+	while ( at < prefix_len )
+	{
+		const char *sym;
+		size_t      n;
+
+		if ( k >= view.len )
+			return 0;
+		if ( code[k] != EZI_SYMTAB_ESC )
+		{
+			sym = (const char *)&tab->symtab->sym[code[k]];
+			n   = tab->symtab->len[code[k]];
+			k++;
+		}
+		else
+		{
+			if ( k + 1ul >= view.len )
+				return 0;
+			sym = (const char *)&code[k + 1ul];
+			n   = 1ul;
+			k  += 2ul;
+		}
+		n = MIN(n, prefix_len - at);
+		if ( memcmp(sym, &prefix[at], n) != 0 )
+			return 0;
+		at += n;
+	}
+	return 1;
+}
+
+int ezi_strtab_prefix(EZI_STRTAB_T *tab, size_t i, EZI_STR_T *prefix)
+{
+	return ezi_strtab_prefix_raw(tab, i, prefix->str, prefix->len);
+}
+
+int ezi_strtab_save(EZI_STRTAB_T *tab, char *path)
+{
+	EZI_STRTAB_FILE_T head;
+	uint64_t          zero = 0ull;
+	FILE             *fp;
+	int               ok;
+
+	if ( tab == NULL || path == NULL || (fp = fopen(path, "wb")) == NULL )
+		return -1;
+
+	memset(&head, 0, sizeof(head));
+	memcpy(head.magic, EZI_STRTAB_MAGIC, sizeof(head.magic));
+	head.version     = EZI_STRTAB_VERSION;
+	head.endian      = EZI_STRTAB_ENDIAN;
+	head.flags       = 0u;
+	head.header_size = EZI_STRTAB_HEADER;
+	head.count       = tab->count;
+	head.index_at    = EZI_STRTAB_HEADER;
+	if ( tab->symtab != NULL )
+	{
+		head.flags     = EZI_STRTAB_COMPRESSED;
+		head.symtab_at = EZI_STRTAB_HEADER;
+		head.index_at  = EZI_STRTAB_HEADER + EZI_SYMTAB_SAVED;
+	}
+	head.data_at     = head.index_at + (tab->count + 1ull) * sizeof(uint64_t);
+	head.data_size   = tab->data_size;
+
+	ok = fwrite(&head, sizeof(head), 1, fp) == 1
+	  && ( tab->symtab == NULL || fwrite(tab->symtab, EZI_SYMTAB_SAVED, 1, fp) == 1 )
+	  && ( tab->count > 0ul ? fwrite(tab->offset, sizeof(uint64_t), tab->count + 1ul, fp) == tab->count + 1ul
+	                        : fwrite(&zero, sizeof(zero), 1, fp) == 1 )
+	  && ( tab->data_size == 0ul || fwrite(tab->data, 1, tab->data_size, fp) == tab->data_size );
+
+	return ( fclose(fp) == 0 && ok ) ? 0 : -1;
+}
+
+// Points 'tab' into a saved image, after checking its header: 0 if OK, else -1.
+int ezi_strtab_from_image(EZI_STRTAB_T *tab, void *image, size_t image_size)
+{
+	EZI_STRTAB_FILE_T head;
+	uint64_t          index_size;
+
+	if ( tab == NULL || image == NULL || image_size < sizeof(head)
+	  || (uintptr_t)image % sizeof(uint64_t) != 0u )  // The index is read in place.
+		return -1;
+
+	memcpy(&head, image, sizeof(head));
+	if ( memcmp(head.magic, EZI_STRTAB_MAGIC, sizeof(head.magic)) != 0
+	  || head.version != EZI_STRTAB_VERSION
+	  || head.endian  != EZI_STRTAB_ENDIAN  // Written on a machine of the other byte order.
+	  || (head.flags & ~EZI_STRTAB_COMPRESSED) != 0u
+	  || head.header_size < sizeof(head)
+	  || head.count >= image_size / sizeof(uint64_t) )
+		return -1;
+
+	index_size = (head.count + 1ull) * sizeof(uint64_t);
+	if ( head.index_at % sizeof(uint64_t) != 0ull
+	  || head.index_at > image_size || index_size > image_size - head.index_at
+	  || head.data_at  > image_size || head.data_size > image_size - head.data_at )
+		return -1;
+
+	if ( head.flags & EZI_STRTAB_COMPRESSED )
+	{
+		EZI_SYMTAB_T *st;
+		size_t        c;
+
+		if ( head.symtab_at > image_size || EZI_SYMTAB_SAVED > image_size - head.symtab_at
+		  || (st = calloc(1, sizeof(EZI_SYMTAB_T))) == NULL )
+			return -1;
+		memcpy(st, (char *)image + head.symtab_at, EZI_SYMTAB_SAVED);
+		for ( c = 0; c < 255 && (c >= st->count || (st->len[c] > 0 && st->len[c] <= 8)); c++ )
+			if ( c >= st->count )
+				st->sym[c] = st->len[c] = 0;
+		if ( c < 255 || st->count > 255ull )
+		{
+			free(st);
+			return -1;
+		}
+		ezi_symtab_index(st);
+		for ( c = 0; c < st->count; c++ )
+			st->sym[c] &= st->mask[st->len[c]];
+
+		ezi_strtab_init(tab);
+		tab->symtab = st;
+	}
+	else
+		ezi_strtab_init(tab);
+
+	tab->image      = image;
+	tab->image_size = image_size;
+	tab->offset     = (uint64_t *)((char *)image + head.index_at);
+	tab->data       = (char *)image + head.data_at;
+	tab->count      = (size_t)head.count;
+	tab->data_size  = (size_t)head.data_size;
+	return 0;
+}
+
+int ezi_strtab_load(EZI_STRTAB_T *tab, char *path)
+{
+	void  *image = NULL;
+	size_t size  = 0ul;
+	int    mapped = 0;
+
+	if ( tab == NULL || path == NULL )
+		return -1;
+
+#ifdef EZI_POSIX
+	{
+		struct stat st;
+		int         fd = open(path, O_RDONLY);
+
+		if ( fd < 0 )
+			return -1;
+		if ( fstat(fd, &st) == 0 && st.st_size > 0 )
+		{
+			size  = (size_t)st.st_size;
+			image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if ( image == MAP_FAILED )
+				image = NULL;
+			mapped = image != NULL;
+		}
+		close(fd);
+	}
+#else
+	{
+		FILE *fp = fopen(path, "rb");
+		long  end;
+
+		if ( fp == NULL )
+			return -1;
+		if ( fseek(fp, 0L, SEEK_END) == 0 && (end = ftell(fp)) > 0 && fseek(fp, 0L, SEEK_SET) == 0
+		  && (image = malloc((size_t)end)) != NULL )
+		{
+			size = (size_t)end;
+			if ( fread(image, 1, size, fp) != size )
+			{
+				free(image);
+				image = NULL;
+			}
+		}
+		fclose(fp);
+	}
+#endif
+
+	if ( image == NULL || ezi_strtab_from_image(tab, image, size) != 0 )
+	{
+#ifdef EZI_POSIX
+		if ( image != NULL )
+			munmap(image, size);
+#else
+		free(image);
+#endif
+		return -1;
+	}
+	tab->mapped = mapped;
+	tab->owned  = !mapped;
+	return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Deferred-format logging.
+
+ezi_log() doesn't format anything: it copies the format pointer, a timestamp and the raw
+argument values (the bytes of any %s string included) into a ring owned by the calling thread,
+and returns.  A background thread takes the records off every thread's ring, formats each with
+vsnprintf(), one conversion at a time, into an Ezi string of up to 'line_max' characters (which is
+truncated like ezi_snprintf()), and write()s them to the fd in batches.
+
+So the format MUST stay valid until the record is written (a string literal, in practice).  No
+newline is added.  The format is scanned at record time only to find the types of the arguments:
+%n, wide %lc/%ls and positional %1$d are not recorded, and the format is written out as it is from
+that conversion on.
+
+Each thread's ring is a lock-free EZI_RING_SPSC ring of 'ring_size' bytes, made on its first
+ezi_log() and freed by the background thread once the thread has exited and its ring is empty.
+When a ring is full, the record is dropped and counted (EZI_LOG_DROP), or ezi_log() waits for room
+(EZI_LOG_BLOCK).  A record holds up to 'line_max' bytes of %s strings (more would be cut from the
+line anyway, so longer strings are cut short) and about 500 more of other arguments (beyond that
+it is dropped), and ezi_log_create() refuses a ring too small for it.
+
+The background thread naps for up to 10ms when there is nothing to do.  ezi_log() only wakes it
+early when its ring is half full, or full with EZI_LOG_BLOCK, so most calls take no lock at all.
+
+ezi_log_stats() counts records, drops, bytes written, and how long records waited to be formatted
+and took to format.
+
+Without EZI_THREADS there is one "ring", and ezi_log() formats the record at once, though the
+writes are still batched: ezi_log_flush() writes what is waiting. */
+
+#ifdef EZI_POSIX
+
+#define EZI_LOG_SPEC_MAX 32ul             // Longest conversion handled, e.g. "%-+#012.6lld".
+#define EZI_LOG_BATCH    (64ul * 1024ul)  // Bytes per write().
+#define EZI_LOG_NAP_NS   10000000l        // Background thread's longest sleep.
+#define EZI_LOG_ARG_MAX  (2ul * sizeof(int64_t) + sizeof(long double) + sizeof(void *))  // '*'s & a value.
+
+typedef struct ezi_log_ring_tag
+{
+	EZI_RING_T               ring;
+	struct ezi_log_ring_tag *next;
+	uint64_t                 recorded;  // Written by the owning thread only.
+	uint64_t                 dropped;   // Ditto.
+	int                      closed;    // The thread has exited.
+	char                    *record;    // Record being built: record_max bytes.
+} EZI_LOG_RING_T;
+
+typedef struct
+{
+	uint32_t    size;    // Of the whole record.
+	const char *format;
+	uint64_t    time_ns;
+} EZI_LOG_REC_T;
+
+// One conversion of a format.
+typedef struct
+{
+	size_t len;        // Including the '%'.
+	size_t size_at;    // Where the length modifier is ...
+	size_t size_len;   // ... and how long.
+	int    size;       // 'H' for hh, 'h', 'l', 'M' for ll, 'j', 'z', 't', 'L', or 0.
+	int    conv;       // The conversion character.
+	int    precision;  // -1: none, -2: '*', else the digits.
+	int    stars;      // 0 to 2 int arguments for '*'.
+} EZI_LOG_SPEC_T;
+
+struct ezi_log_struct_tag
+{
+	int              fd;
+	int              policy;
+	size_t           ring_size;
+	size_t           record_max;
+	EZI_STR_T       *line;     // Formatted by ...
+	EZI_STR_T       *batch;    // ... and written by the background thread.
+	EZI_LOG_STATS_T  stats;    // Totals, apart from the rings' own counts.
+	EZI_LOG_STATS_T  pass;     // Counts of the background thread, not yet in 'stats'.
+	EZI_LOG_RING_T  *rings;
+#ifdef EZI_THREADS
+	pthread_key_t    key;
+	pthread_t        tid;
+	pthread_mutex_t  lock;     // For rings, stats & the following.
+	pthread_cond_t   wake;
+	pthread_cond_t   flushed;
+	int              sleeping;
+	int              quit;
+	uint64_t         flush_asked;
+	uint64_t         flush_done;
+#endif
+};
+
+static uint64_t ezi_log_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Parses the conversion at fmt[0] == '%': 0 if it can't be recorded.
+static int ezi_log_spec(const char *fmt, EZI_LOG_SPEC_T *spec)
+{
+	const char *at = fmt + 1;
+
+	memset(spec, 0, sizeof(*spec));
+	spec->precision = -1;
+	if ( *at == '%' )
+	{
+		spec->conv = '%';
+		spec->len  = 2ul;
+		return 1;
+	}
+
+	while ( *at != '\0' && strchr("-+ #0'", *at) != NULL )
+		at++;
+	if ( *at == '*' )
+	{
+		spec->stars++;
+		at++;
+	}
+	else
+		while ( isdigit((unsigned char)*at) )
+			at++;
+	if ( *at == '$' )
+		return 0;  // Positional.
+	if ( *at == '.' )
+	{
+		at++;
+		if ( *at == '*' )
+		{
+			spec->stars++;
+			spec->precision = -2;
+			at++;
+		}
+		else
+			for ( spec->precision = 0; isdigit((unsigned char)*at); at++ )
+				spec->precision = MIN(spec->precision * 10 + (*at - '0'), 1000000);
+	}
+
+	spec->size_at = (size_t)(at - fmt);
+	switch ( *at )
+	{
+	case 'h': spec->size = at[1] == 'h' ? 'H' : 'h'; break;
+	case 'l': spec->size = at[1] == 'l' ? 'M' : 'l'; break;
+	case 'j': case 'z': case 't': case 'L': spec->size = *at; break;
+	}
+	spec->size_len = spec->size == 'H' || spec->size == 'M' ? 2ul : spec->size ? 1ul : 0ul;
+	at += spec->size_len;
+
+	spec->conv = *at;
+	spec->len  = (size_t)(at - fmt) + 1ul;
+	if ( spec->conv == '\0' || strchr("diouxXeEfFgGaAcsp", spec->conv) == NULL
+	  || spec->len > EZI_LOG_SPEC_MAX )
+		return 0;
+	if ( strchr("diouxX", spec->conv) != NULL )
+		return spec->size != 'L';
+	if ( strchr("eEfFgGaA", spec->conv) != NULL )
+		return spec->size == 0 || spec->size == 'l' || spec->size == 'L';
+	return spec->size == 0;  // Not wide %lc or %ls.
+}
+
+static void ezi_log_put(EZI_LOG_T *log, const char *from, size_t from_len, int *cut)
+{
+	EZI_STR_T *line = log->line;
+	size_t     n    = MIN(from_len, line->max - line->len);
+
+	memcpy(&line->str[line->len], from, n);
+	line->len += n;
+	*cut = n < from_len;
+}
+
+// Formats one record into log->line.
+static void ezi_log_format(EZI_LOG_T *log, const char *record)
+{
+	EZI_LOG_REC_T  head;
+	EZI_STR_T     *line = log->line;
+	const char    *arg  = record + sizeof(head);
+	const char    *fmt;
+	int            cut  = 0;
+
+	memcpy(&head, record, sizeof(head));
+	line->len = 0ul;
+	for ( fmt = head.format; *fmt != '\0' && !cut; )
+	{
+		EZI_LOG_SPEC_T spec;
+		char           piece[EZI_LOG_SPEC_MAX + 48];  // The spec, with stars as digits & "ll".
+		char          *to = piece;
+		size_t         i, room = line->max - line->len;
+		int            n = 0;
+		int64_t        star;
+
+		if ( *fmt != '%' )
+		{
+			const char *pc = strchr(fmt, '%');
+			size_t      len = pc ? (size_t)(pc - fmt) : strlen(fmt);
+
+			ezi_log_put(log, fmt, len, &cut);
+			fmt += len;
+			continue;
+		}
+		if ( !ezi_log_spec(fmt, &spec) )
+		{
+			ezi_log_put(log, fmt, strlen(fmt), &cut);
+			break;
+		}
+		if ( spec.conv == '%' )
+		{
+			ezi_log_put(log, "%", 1ul, &cut);
+			fmt += spec.len;
+			continue;
+		}
+
+		for ( i = 0; i + 1ul < spec.len; )  // Up to the conversion: the length modifier is redone below.
+		{
+			if ( i == spec.size_at && spec.size_len > 0ul )
+				i += spec.size_len;
+			else if ( fmt[i] == '*' )
+			{
+				memcpy(&star, arg, sizeof(star));
+				arg += sizeof(star);
+				if ( star < 0 && to[-1] == '.' )
+					to--;  // A negative precision is taken as none.
+				else
+					to += sprintf(to, "%d", (int)star);
+				i++;
+			}
+			else
+				*to++ = fmt[i++];
+		}
+		if ( strchr("diouxX", spec.conv) != NULL )
+		{
+			*to++ = 'l';
+			*to++ = 'l';
+		}
+		else if ( spec.size == 'L' )
+			*to++ = 'L';
+		*to++ = (char)spec.conv;
+		*to   = '\0';
+
+		switch ( spec.conv )
+		{
+		case 'd': case 'i':
+		case 'o': case 'u': case 'x': case 'X':
+		{
+			uint64_t v;
+
+			memcpy(&v, arg, sizeof(v));
+			arg += sizeof(v);
+			if ( spec.conv == 'd' || spec.conv == 'i' )
+				n = snprintf(&line->str[line->len], room + 1ul, piece, (long long)(int64_t)v);
+			else
+				n = snprintf(&line->str[line->len], room + 1ul, piece, (unsigned long long)v);
+			break;
+		}
+		case 'c':
+		{
+			int64_t v;
+
+			memcpy(&v, arg, sizeof(v));
+			arg += sizeof(v);
+			n = snprintf(&line->str[line->len], room + 1ul, piece, (int)v);
+			break;
+		}
+		case 'p':
+		{
+			void *v;
+
+			memcpy(&v, arg, sizeof(v));
+			arg += sizeof(v);
+			n = snprintf(&line->str[line->len], room + 1ul, piece, v);
+			break;
+		}
+		case 's':
+		{
+			uint32_t len;
+
+			memcpy(&len, arg, sizeof(len));
+			n = snprintf(&line->str[line->len], room + 1ul, piece, arg + sizeof(len));
+			arg += sizeof(len) + len + 1ul;
+			break;
+		}
+		default:
+			if ( spec.size == 'L' )
+			{
+				long double v;
+
+				memcpy(&v, arg, sizeof(v));
+				arg += sizeof(v);
+				n = snprintf(&line->str[line->len], room + 1ul, piece, v);
+			}
+			else
+			{
+				double v;
+
+				memcpy(&v, arg, sizeof(v));
+				arg += sizeof(v);
+				n = snprintf(&line->str[line->len], room + 1ul, piece, v);
+			}
+			break;
+		}
+
+		if ( n > 0 )
+		{
+			line->len += MIN((size_t)n, room);
+			cut = (size_t)n > room;
+		}
+		fmt += spec.len;
+	}
+
+	line->str[line->len] = '\0';
+#ifdef EZI_UTF8
+	if ( cut )
+		ezi_utf8_backoff(line, 0ul);
+#endif
+}
+
+#ifdef EZI_THREADS
+static void ezi_log_gone(void *ring)
+{
+	__atomic_store_n(&((EZI_LOG_RING_T *)ring)->closed, 1, __ATOMIC_RELEASE);
+}
+
+static void ezi_log_wake(EZI_LOG_T *log)
+{
+	if ( __atomic_load_n(&log->sleeping, __ATOMIC_SEQ_CST) )
+	{
+		pthread_mutex_lock(&log->lock);
+		pthread_cond_signal(&log->wake);
+		pthread_mutex_unlock(&log->lock);
+	}
+}
+#endif
+
+static EZI_LOG_RING_T *ezi_log_ring_new(EZI_LOG_T *log)
+{
+	EZI_LOG_RING_T *ring = calloc(1, sizeof(EZI_LOG_RING_T) + log->ring_size + log->record_max);
+
+	if ( ring == NULL )
+		return NULL;
+	ezi_ring_init(&ring->ring, (char *)(ring + 1), log->ring_size, EZI_RING_SPSC);
+	ring->record = (char *)(ring + 1) + log->ring_size;
+	return ring;
+}
+
+// Writes the batch out: the background thread only (or the caller, without EZI_THREADS).
+static void ezi_log_write(EZI_LOG_T *log)
+{
+	size_t done = 0ul;
+
+	while ( done < log->batch->len )
+	{
+		ssize_t n = write(log->fd, &log->batch->str[done], log->batch->len - done);
+
+		if ( n < 0 && errno == EINTR )
+			continue;
+		if ( n <= 0 )
+		{
+			log->pass.write_errors++;
+			break;
+		}
+		done += (size_t)n;
+	}
+	log->pass.written += done;
+	log->batch->len = 0ul;
+}
+
+// Adds the background thread's counts to the totals: under the lock, with EZI_THREADS.
+static void ezi_log_merge(EZI_LOG_T *log)
+{
+	log->stats.formatted        += log->pass.formatted;
+	log->stats.written          += log->pass.written;
+	log->stats.write_errors     += log->pass.write_errors;
+	log->stats.format_ns_total  += log->pass.format_ns_total;
+	log->stats.latency_ns_total += log->pass.latency_ns_total;
+	log->stats.latency_ns_max    = MAX(log->stats.latency_ns_max, log->pass.latency_ns_max);
+	memset(&log->pass, 0, sizeof(log->pass));
+}
+
+// Formats a record & adds it to the batch.
+static void ezi_log_take(EZI_LOG_T *log, const char *record)
+{
+	uint64_t begin = ezi_log_now(), end;
+	uint64_t time_ns;
+
+	memcpy(&time_ns, record + offsetof(EZI_LOG_REC_T, time_ns), sizeof(time_ns));
+	ezi_log_format(log, record);
+	end = ezi_log_now();
+
+	log->pass.formatted++;
+	log->pass.format_ns_total  += end - begin;
+	log->pass.latency_ns_total += begin - time_ns;
+	log->pass.latency_ns_max    = MAX(log->pass.latency_ns_max, begin - time_ns);
+
+	if ( log->line->len > log->batch->max - log->batch->len )
+		ezi_log_write(log);
+	memcpy(&log->batch->str[log->batch->len], log->line->str, log->line->len);
+	log->batch->len += log->line->len;
+}
+
+#ifdef EZI_THREADS
+// Takes what was in the ring when it started: returns the number of records.
+static size_t ezi_log_drain(EZI_LOG_T *log, EZI_LOG_RING_T *ring, char *record)
+{
+	size_t   used = ezi_ring_used(&ring->ring), taken = 0ul;
+	uint32_t size;
+
+	while ( used >= sizeof(EZI_LOG_REC_T) )
+	{
+		ezi_ring_copy(&ring->ring, 0ul, (char *)&size, sizeof(size));
+		ezi_ring_pop_raw(&ring->ring, record, size);
+		ezi_log_take(log, record);
+		used -= size;
+		taken++;
+	}
+	return taken;
+}
+
+static void *ezi_log_thread(void *arg)
+{
+	EZI_LOG_T *log    = arg;
+	char      *record = malloc(log->record_max);
+	int        quit   = 0;
+
+	while ( record != NULL )
+	{
+		EZI_LOG_RING_T  *ring, **link;
+		uint64_t         asked;
+		size_t           taken = 0ul;
+
+		pthread_mutex_lock(&log->lock);
+		asked = log->flush_asked;
+		quit  = log->quit;
+		ring  = log->rings;  // Rings are only added at the head, and only removed by this thread.
+		pthread_mutex_unlock(&log->lock);
+
+		for ( ; ring != NULL; ring = ring->next )
+			taken += ezi_log_drain(log, ring, record);
+		if ( log->batch->len > 0ul )
+			ezi_log_write(log);
+
+		pthread_mutex_lock(&log->lock);
+		for ( link = &log->rings; (ring = *link) != NULL; )
+		{
+			if ( __atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE) && ezi_ring_used(&ring->ring) == 0ul )
+			{
+				log->stats.recorded += ring->recorded;
+				log->stats.dropped  += ring->dropped;
+				*link = ring->next;
+				free(ring);
+			}
+			else
+				link = &ring->next;
+		}
+		ezi_log_merge(log);
+		log->flush_done = asked;
+		pthread_cond_broadcast(&log->flushed);
+
+		if ( quit && taken == 0ul )
+		{
+			pthread_mutex_unlock(&log->lock);
+			break;
+		}
+		if ( taken == 0ul && log->flush_asked == asked && !log->quit )
+		{
+			struct timespec until;
+
+			// A record pushed just as we go to sleep is picked up when the nap ends at the latest.
+			clock_gettime(CLOCK_REALTIME, &until);
+			until.tv_nsec += EZI_LOG_NAP_NS;
+			if ( until.tv_nsec >= 1000000000l )
+			{
+				until.tv_sec++;
+				until.tv_nsec -= 1000000000l;
+			}
+			__atomic_store_n(&log->sleeping, 1, __ATOMIC_SEQ_CST);
+			pthread_cond_timedwait(&log->wake, &log->lock, &until);
+			__atomic_store_n(&log->sleeping, 0, __ATOMIC_SEQ_CST);
+		}
+		pthread_mutex_unlock(&log->lock);
+	}
+
+	free(record);
+	return NULL;
+}
+#endif
+
+// Returns NULL if out of memory, if ring_size isn't a power of 2, or if it can't hold a whole line.
+EZI_LOG_T *ezi_log_create(int fd, size_t ring_size, size_t line_max, int policy)
+{
+	EZI_LOG_T *log;
+
+	if ( ring_size == 0ul || (ring_size & (ring_size - 1ul)) != 0ul || line_max == 0ul
+	  || (log = calloc(1, sizeof(EZI_LOG_T))) == NULL )
+		return NULL;
+
+	log->fd         = fd;
+	log->policy     = policy;
+	log->ring_size  = ring_size;
+	log->record_max = sizeof(EZI_LOG_REC_T) + line_max + 512ul;  // A line's worth of %s, and many numbers.
+	log->line       = ezi_calloc(line_max);
+	log->batch      = ezi_calloc(MAX(EZI_LOG_BATCH, line_max));
+	if ( log->line == NULL || log->batch == NULL || log->record_max > ring_size
+#ifdef EZI_THREADS
+	  || pthread_key_create(&log->key, ezi_log_gone) != 0 )
+#else
+	  || (log->rings = ezi_log_ring_new(log)) == NULL )
+#endif
+	{
+		free(log->line);
+		free(log->batch);
+		free(log);
+		return NULL;
+	}
+
+#ifdef EZI_THREADS
+	pthread_mutex_init(&log->lock, NULL);
+	pthread_cond_init(&log->wake, NULL);
+	pthread_cond_init(&log->flushed, NULL);
+	if ( pthread_create(&log->tid, NULL, ezi_log_thread, log) != 0 )
+	{
+		pthread_cond_destroy(&log->flushed);
+		pthread_cond_destroy(&log->wake);
+		pthread_mutex_destroy(&log->lock);
+		pthread_key_delete(log->key);
+		free(log->line);
+		free(log->batch);
+		free(log);
+		return NULL;
+	}
+#endif
+	return log;
+}
+
+// Writes everything recorded so far.  No thread may be in ezi_log() for this log any more.
+void ezi_log_destroy(EZI_LOG_T *log)
+{
+	EZI_LOG_RING_T *ring;
+
+	if ( log == NULL )
+		return;
+
+#ifdef EZI_THREADS
+	pthread_mutex_lock(&log->lock);
+	log->quit = 1;
+	pthread_cond_signal(&log->wake);
+	pthread_mutex_unlock(&log->lock);
+	pthread_join(log->tid, NULL);
+	pthread_key_delete(log->key);
+	pthread_cond_destroy(&log->flushed);
+	pthread_cond_destroy(&log->wake);
+	pthread_mutex_destroy(&log->lock);
+#else
+	ezi_log_write(log);
+#endif
+
+	while ( (ring = log->rings) != NULL )
+	{
+		log->rings = ring->next;
+		free(ring);
+	}
+	free(log->line);
+	free(log->batch);
+	free(log);
+}
+
+// 0 if recorded, -1 if dropped.
+int ezi_vlog(EZI_LOG_T *log, const char *format, va_list args)
+{
+	EZI_LOG_RING_T *ring;
+	EZI_LOG_REC_T   head;
+	const char     *fmt = format;
+	char           *at, *end;
+	size_t          strings = 0ul;  // Bytes of %s so far: the line can't show more than line_max.
+
+#ifndef MEMORY_CONFIDENCE
+	if ( log == NULL || format == NULL )
+		return -1;
+#endif
+
+#ifdef EZI_THREADS
+	if ( (ring = pthread_getspecific(log->key)) == NULL )
+	{
+		if ( (ring = ezi_log_ring_new(log)) == NULL || pthread_setspecific(log->key, ring) != 0 )
+		{
+			free(ring);
+			pthread_mutex_lock(&log->lock);
+			log->stats.dropped++;
+			pthread_mutex_unlock(&log->lock);
+			return -1;
+		}
+		pthread_mutex_lock(&log->lock);
+		ring->next = log->rings;
+		log->rings = ring;
+		pthread_mutex_unlock(&log->lock);
+	}
+#else
+	ring = log->rings;
+#endif
+
+	at  = ring->record + sizeof(head);
+	end = ring->record + log->record_max;
+	while ( (fmt = strchr(fmt, '%')) != NULL )
+	{
+		EZI_LOG_SPEC_T spec;
+		int            stars[2] = { 0, 0 };
+		int            k;
+		int64_t        i64;
+		uint64_t       u64;
+
+		if ( !ezi_log_spec(fmt, &spec) )
+			break;  // Written out as it is from here.
+		fmt += spec.len;
+		if ( spec.conv == '%' )
+			continue;
+
+		if ( at + EZI_LOG_ARG_MAX > end )
+			goto drop;
+		for ( k = 0; k < spec.stars; k++ )
+		{
+			stars[k] = va_arg(args, int);
+			i64      = stars[k];
+			memcpy(at, &i64, sizeof(i64));
+			at += sizeof(i64);
+		}
+		if ( spec.precision == -2 )
+			spec.precision = stars[spec.stars - 1] >= 0 ? stars[spec.stars - 1] : -1;
+
+		switch ( spec.conv )
+		{
+		case 'd': case 'i':
+			switch ( spec.size )
+			{
+			case 'H': i64 = (signed char)va_arg(args, int);   break;
+			case 'h': i64 = (short)va_arg(args, int);         break;
+			case 'l': i64 = va_arg(args, long);               break;
+			case 'M': i64 = va_arg(args, long long);          break;
+			case 'j': i64 = va_arg(args, intmax_t);           break;
+			case 'z': i64 = (ptrdiff_t)va_arg(args, size_t);  break;
+			case 't': i64 = va_arg(args, ptrdiff_t);          break;
+			default:  i64 = va_arg(args, int);                break;
+			}
+			memcpy(at, &i64, sizeof(i64));
+			at += sizeof(i64);
+			break;
+		case 'o': case 'u': case 'x': case 'X':
+			switch ( spec.size )
+			{
+			case 'H': u64 = (unsigned char)va_arg(args, unsigned);   break;
+			case 'h': u64 = (unsigned short)va_arg(args, unsigned);  break;
+			case 'l': u64 = va_arg(args, unsigned long);             break;
+			case 'M': u64 = va_arg(args, unsigned long long);        break;
+			case 'j': u64 = va_arg(args, uintmax_t);                 break;
+			case 'z': u64 = va_arg(args, size_t);                    break;
+			case 't': u64 = (uint64_t)va_arg(args, ptrdiff_t);       break;
+			default:  u64 = va_arg(args, unsigned);                  break;
+			}
+			memcpy(at, &u64, sizeof(u64));
+			at += sizeof(u64);
+			break;
+		case 'c':
+			i64 = va_arg(args, int);
+			memcpy(at, &i64, sizeof(i64));
+			at += sizeof(i64);
+			break;
+		case 'p':
+		{
+			void *p = va_arg(args, void *);
+
+			memcpy(at, &p, sizeof(p));
+			at += sizeof(p);
+			break;
+		}
+		case 's':
+		{
+			const char *s    = va_arg(args, const char *);
+			size_t      room = (size_t)(end - at);
+			size_t      max  = log->line->max - strings;
+			uint32_t    len;
+			const char *nul;
+
+			if ( s == NULL )
+				s = "(null)";
+			// Room is kept for the conversions after it.
+			max = MIN(max, room > EZI_LOG_ARG_MAX + sizeof(len) + 1ul ? room - EZI_LOG_ARG_MAX - sizeof(len) - 1ul : 0ul);
+			if ( spec.precision >= 0 )
+				max = MIN(max, (size_t)spec.precision);
+			len = (uint32_t)( (nul = memchr(s, '\0', max)) != NULL ? (size_t)(nul - s) : max );
+			memcpy(at, &len, sizeof(len));
+			memcpy(at + sizeof(len), s, len);
+			at[sizeof(len) + len] = '\0';
+			at      += sizeof(len) + len + 1ul;
+			strings += len;
+			break;
+		}
+		default:
+			if ( spec.size == 'L' )
+			{
+				long double v = va_arg(args, long double);
+
+				memcpy(at, &v, sizeof(v));
+				at += sizeof(v);
+			}
+			else
+			{
+				double v = va_arg(args, double);
+
+				memcpy(at, &v, sizeof(v));
+				at += sizeof(v);
+			}
+			break;
+		}
+	}
+
+	head.size    = (uint32_t)(at - ring->record);
+	head.format  = format;
+	head.time_ns = ezi_log_now();
+	memcpy(ring->record, &head, sizeof(head));
+
+#ifdef EZI_THREADS
+	while ( ezi_ring_room(&ring->ring) < head.size )
+	{
+		if ( log->policy != EZI_LOG_BLOCK )
+			goto drop;
+		ezi_log_wake(log);
+		sched_yield();
+	}
+	ezi_ring_push_raw(&ring->ring, ring->record, head.size);
+	__atomic_store_n(&ring->recorded, ring->recorded + 1ull, __ATOMIC_RELAXED);
+	if ( ezi_ring_used(&ring->ring) >= log->ring_size / 2ul )  // Otherwise the nap's end will do.
+		ezi_log_wake(log);
+#else
+	ezi_log_take(log, ring->record);
+	ring->recorded++;
+#endif
+	return 0;
+
+drop:
+	__atomic_store_n(&ring->dropped, ring->dropped + 1ull, __ATOMIC_RELAXED);
+	return -1;
+}
+
+int ezi_log(EZI_LOG_T *log, const char *format, ...)
+{
+	va_list args;
+	int     result;
+
+	va_start(args, format);
+	result = ezi_vlog(log, format, args);
+	va_end(args);
+	return result;
+}
+
+// Returns once everything recorded before the call (by any thread) has been written.
+void ezi_log_flush(EZI_LOG_T *log)
+{
+	if ( log == NULL )
+		return;
+
+#ifdef EZI_THREADS
+	pthread_mutex_lock(&log->lock);
+	{
+		uint64_t asked = ++log->flush_asked;
+
+		pthread_cond_signal(&log->wake);
+		while ( log->flush_done < asked )
+			pthread_cond_wait(&log->flushed, &log->lock);
+	}
+	pthread_mutex_unlock(&log->lock);
+#else
+	ezi_log_write(log);
+#endif
+}
+
+void ezi_log_stats(EZI_LOG_T *log, EZI_LOG_STATS_T *stats)
+{
+	EZI_LOG_RING_T *ring;
+
+	memset(stats, 0, sizeof(*stats));
+	if ( log == NULL )
+		return;
+
+#ifdef EZI_THREADS
+	pthread_mutex_lock(&log->lock);
+#else
+	ezi_log_merge(log);
+#endif
+	*stats = log->stats;
+	for ( ring = log->rings; ring != NULL; ring = ring->next )
+	{
+		stats->recorded += __atomic_load_n(&ring->recorded, __ATOMIC_RELAXED);
+		stats->dropped  += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+	}
+#ifdef EZI_THREADS
+	pthread_mutex_unlock(&log->lock);
+#endif
+}
+
+#endif // EZI_POSIX
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Replacing: ezi_replace() replaces the first 'find' in 'from' with 'with', ezi_replace_all()
+replaces every one (left to right, not overlapping), and either puts the result in 'to',
+truncated like ezi_cpy().  'to' may be 'from'.  An empty 'find' replaces nothing.
+
+The first pass finds the matches and works out how much of 'from' fits in 'to'; the second builds
+the result, so k replacements in n bytes cost O(n), not O(k * n).
+
+In place, a result no longer than the string is built forwards, and never catches up with what is
+still to be read.  A longer one is built forwards too, after moving the part of the string that
+is used to the end of the buffer: the writing then stays behind the reading the whole way. */
+
+// Leftmost 'find' in hay[0 .. hay_len), or NULL.
+static char *ezi_find(char *hay, size_t hay_len, char *find, size_t find_len)
+{
+	char *end = hay + hay_len;
+
+	while ( (size_t)(end - hay) >= find_len
+	     && (hay = memchr(hay, find[0], (size_t)(end - hay) - find_len + 1ul)) != NULL )
+	{
+		if ( memcmp(hay, find, find_len) == 0 )
+			return hay;
+		hay++;
+	}
+	return NULL;
+}
+
+static EZI_STR_T *ezi_replace_private(EZI_STR_T *to, EZI_STR_T *from, char *find, size_t find_len,
+                                      char *with, size_t with_len, size_t limit)
+{
+	char   *src, *hit;
+	size_t  used = 0ul;  // Bytes of 'from' in the result ...
+	size_t  out  = 0ul;  // ... which make this much of it ...
+	size_t  part = 0ul;  // ... before part of one more 'with', if that was cut off.
+	size_t  count, at, n;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( to == NULL || from == NULL || (find == NULL && find_len > 0ul) || (with == NULL && with_len > 0ul) )
+		return to;
+#endif
+
+	if ( find_len == 0ul )
+		limit = 0ul;
+
+	// Pass 1: how much fits.
+	for ( count = 0ul; used < from->len; count++ )
+	{
+		hit = count < limit ? ezi_find(&from->str[used], from->len - used, find, find_len) : NULL;
+		n   = hit ? (size_t)(hit - &from->str[used]) : from->len - used;
+		if ( n > to->max - out )
+		{
+			used += to->max - out;
+			out   = to->max;
+			break;
+		}
+		used += n;
+		out  += n;
+		if ( hit == NULL )
+			break;
+		if ( with_len > to->max - out )
+		{
+			part = to->max - out;
+			break;
+		}
+		used += find_len;
+		out  += with_len;
+	}
+
+	// Pass 2: build it.
+	src = from->str;
+	if ( to == from && with_len > find_len )
+	{
+		src = &to->str[to->max - used];
+		memmove(src, to->str, used);
+	}
+	for ( at = 0ul, out = 0ul, count = 0ul; at < used; count++ )
+	{
+		hit = count < limit ? ezi_find(&src[at], used - at, find, find_len) : NULL;
+		n   = hit ? (size_t)(hit - &src[at]) : used - at;
+		memmove(&to->str[out], &src[at], n);
+		out += n;
+		at  += n;
+		if ( hit == NULL )
+			break;
+		memcpy(&to->str[out], with, with_len);
+		out += with_len;
+		at  += find_len;
+	}
+	memcpy(&to->str[out], with, part);
+	to->len = out + part;
+	to->str[to->len] = '\0';
+#ifdef EZI_UTF8
+	if ( used < from->len )
+		ezi_utf8_backoff(to, 0ul);
+#endif
+
+	return to;
+}
+
+EZI_STR_T *ezi_replace(EZI_STR_T *to, EZI_STR_T *from, EZI_STR_T *find, EZI_STR_T *with)
+{
+	return ezi_replace_private(to, from, find->str, find->len, with->str, with->len, 1ul);
+}
+
+EZI_STR_T *ezi_replace_raw(EZI_STR_T *to, EZI_STR_T *from, char *find, char *with)
+{
+	return ezi_replace_private(to, from, find, find ? strlen(find) : 0ul, with, with ? strlen(with) : 0ul, 1ul);
+}
+
+EZI_STR_T *ezi_replace_all(EZI_STR_T *to, EZI_STR_T *from, EZI_STR_T *find, EZI_STR_T *with)
+{
+	return ezi_replace_private(to, from, find->str, find->len, with->str, with->len, (size_t)-1);
+}
+
+EZI_STR_T *ezi_replace_all_raw(EZI_STR_T *to, EZI_STR_T *from, char *find, char *with)
+{
+	return ezi_replace_private(to, from, find, find ? strlen(find) : 0ul, with, with ? strlen(with) : 0ul, (size_t)-1);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Compiled glob patterns, as fnmatch() without flags: '*' matches any bytes, '?' any one byte,
+and "[...]" one of a set: ranges like "a-z", '!' or '^' first for "none of", ']' first or '-'
+first or last for themselves.  '\' makes the next character (in a set too) stand for itself.  An
+unclosed '[' is itself.  '/' and '.' are not special, and bytes are matched, not UTF-8 characters.
+
+ezi_glob_compile() turns the pattern into segments split at the '*'s, each a fixed-length run of
+one-byte tests (a byte, any byte, or a set as a 256-bit map).  As '*' matches anything, the first
+segment must match at the start, the last at the end, and each one between can just go at its
+leftmost place after the one before: so matching is iterative, never backtracks, and takes no
+more than one pass for each segment, with memchr()/memcmp() for the runs with no '?' or sets. */
+
+#define EZI_GLOB_ANY  256u  // Tokens: 0-255 a byte, then '?', then EZI_GLOB_SET + n for set n.
+#define EZI_GLOB_SET  257u
+
+typedef struct
+{
+	size_t at;       // tokens[at .. at + len)
+	size_t len;
+	int    literal;  // Only bytes, which are also in text[at .. at + len).
+} EZI_GLOB_SEG_T;
+
+struct ezi_glob_struct_tag
+{
+	size_t          segments;  // Number of '*' runs + 1.
+	EZI_GLOB_SEG_T *seg;
+	uint16_t       *token;
+	char           *text;
+	uint8_t        (*set)[32];
+};
+
+// Parses the set at p[0] == '['.  Returns what follows the ']', or NULL if it isn't closed.
+static const char *ezi_glob_set(const char *p, uint8_t set[32])
+{
+	int negate, c, hi, first = 1;
+
+	memset(set, 0, 32);
+	p++;
+	negate = *p == '!' || *p == '^';
+	p += negate;
+	for ( ; *p != '\0' && (*p != ']' || first); first = 0 )
+	{
+		if ( *p == '\\' && p[1] != '\0' )
+			p++;
+		c = (unsigned char)*p++;
+		hi = c;
+		if ( *p == '-' && p[1] != ']' && p[1] != '\0' )
+		{
+			p++;
+			if ( *p == '\\' && p[1] != '\0' )
+				p++;
+			hi = (unsigned char)*p++;
+		}
+		for ( ; c <= hi; c++ )
+			set[c >> 3] |= (uint8_t)(1u << (c & 7));
+	}
+	if ( *p != ']' )
+		return NULL;
+	if ( negate )
+		for ( c = 0; c < 32; c++ )
+			set[c] = (uint8_t)~set[c];
+	return p + 1;
+}
+
+// Returns NULL if out of memory.
+EZI_GLOB_T *ezi_glob_compile(char *pattern)
+{
+	size_t      len, tokens = 0ul, sets = 0ul;
+	EZI_GLOB_T *glob;
+	const char *p;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( pattern == NULL )
+		return NULL;
+#endif
+
+	len = strlen(pattern);
+	glob = calloc(1, sizeof(EZI_GLOB_T));
+	if ( glob == NULL
+	  || (glob->seg   = calloc(len + 1ul, sizeof(EZI_GLOB_SEG_T))) == NULL
+	  || (glob->token = malloc((len + 1ul) * sizeof(uint16_t))) == NULL
+	  || (glob->text  = malloc(len + 1ul)) == NULL
+	  || (glob->set   = malloc((len / 2ul + 1ul) * 32ul)) == NULL )
+	{
+		ezi_glob_free(glob);
+		return NULL;
+	}
+
+	glob->segments = 1ul;
+	glob->seg[0].literal = 1;
+	for ( p = pattern; *p != '\0'; )
+	{
+		EZI_GLOB_SEG_T *seg = &glob->seg[glob->segments - 1ul];
+		const char     *next;
+		unsigned        token;
+
+		if ( *p == '*' )
+		{
+			while ( *p == '*' )
+				p++;
+			seg = &glob->seg[glob->segments++];
+			seg->at      = tokens;
+			seg->literal = 1;
+			continue;
+		}
+		if ( *p == '?' )
+		{
+			token = EZI_GLOB_ANY;
+			p++;
+		}
+		else if ( *p == '[' && (next = ezi_glob_set(p, glob->set[sets])) != NULL )
+		{
+			token = EZI_GLOB_SET + (unsigned)sets++;
+			p = next;
+		}
+		else
+		{
+			if ( *p == '\\' && p[1] != '\0' )
+				p++;
+			token = (unsigned char)*p++;
+		}
+		glob->text[tokens]    = (char)token;
+		glob->token[tokens++] = (uint16_t)token;
+		seg->len++;
+		seg->literal &= token < EZI_GLOB_ANY;
+	}
+	return glob;
+}
+
+void ezi_glob_free(EZI_GLOB_T *glob)
+{
+	if ( glob == NULL )
+		return;
+	free(glob->seg);
+	free(glob->token);
+	free(glob->text);
+	free(glob->set);
+	free(glob);
+}
+
+static int ezi_glob_seg_at(EZI_GLOB_T *glob, EZI_GLOB_SEG_T *seg, const unsigned char *s)
+{
+	const uint16_t *token = &glob->token[seg->at];
+	size_t          i;
+
+	if ( seg->literal )
+		return memcmp(s, &glob->text[seg->at], seg->len) == 0;
+	for ( i = 0; i < seg->len; i++ )
+	{
+		unsigned t = token[i];
+
+		if ( t < EZI_GLOB_ANY ? s[i] != t
+		   : t > EZI_GLOB_ANY && !(glob->set[t - EZI_GLOB_SET][s[i] >> 3] & (1u << (s[i] & 7))) )
+			return 0;
+	}
+	return 1;
+}
+
+int ezi_glob_match_raw(EZI_GLOB_T *glob, char *str, size_t len)
+{
+	const unsigned char *s = (const unsigned char *)str;
+	EZI_GLOB_SEG_T      *first, *last;
+	size_t               at, end, k;
+
+#ifndef MEMORY_CONFIDENCE
+	if ( glob == NULL || (str == NULL && len > 0ul) )
+		return 0;
+#endif
+
+	first = &glob->seg[0];
+	last  = &glob->seg[glob->segments - 1ul];
+	if ( glob->segments == 1ul )
+		return len == first->len && ezi_glob_seg_at(glob, first, s);
+
+	if ( first->len + last->len > len
+	  || !ezi_glob_seg_at(glob, first, s)
+	  || !ezi_glob_seg_at(glob, last, s + len - last->len) )
+		return 0;
+
+	// The middle segments, each at its leftmost place in what's left between the two ends.
+	at  = first->len;
+	end = len - last->len;
+	for ( k = 1ul; k + 1ul < glob->segments; k++ )
+	{
+		EZI_GLOB_SEG_T *seg = &glob->seg[k];
+
+		if ( seg->literal && seg->len > 0ul )
+		{
+			char *hit = ezi_find((char *)&s[at], end - at, &glob->text[seg->at], seg->len);
+
+			if ( hit == NULL )
+				return 0;
+			at = (size_t)((unsigned char *)hit - s);
+		}
+		else
+		{
+			for ( ; at + seg->len <= end && !ezi_glob_seg_at(glob, seg, &s[at]); at++ )
+				;
+			if ( at + seg->len > end )
+				return 0;
+		}
+		at += seg->len;
+	}
+	return 1;
+}
+
+int ezi_glob_match(EZI_GLOB_T *glob, EZI_STR_T *str)
+{
+	return ezi_glob_match_raw(glob, str->str, str->len);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_ALLOC_TEST_APP
+
+#include "alflb.h"
+
+void p(EZI_STR_T *ezi, char *text)
+{
+	printf("%p:%3u:%3u:%-20.20s %s\n", ezi, (uint32_t)(ezi ? ezi->max : 0), (uint32_t)(ezi ? ezi->len : 0), ezi ? ezi->str : "<null>", text);
+	fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+	EZI_STR_T *a;
+	EZI_STR_T *b;
+	EZI_STR_T *c;
+	EZI_STR_T *d;
+	EZI_STR_T *e;
+	a = ezi_calloc(10);              p(a, "a = ezi_calloc(10);"              );
+	ezi_cpy_raw(a, "testing");       p(a, "    ezi_cpy_raw(a, \"testing\");" );
+	b = ezi_dup_raw("hello world");  p(b, "b = ezi_dup_raw(\"hello world\");");
+	b = ezi_realloc(b, 500);         p(b, "b = ezi_realloc(b, 500);"         );
+	b = ezi_realloc(b, 11);          p(b, "b = ezi_realloc(b, 11);"          );
+	b = ezi_realloc(b, 3);           p(b, "b = ezi_realloc(b, 3);"           );
+	c = ezi_calloc(0);               p(c, "c = ezi_calloc(0);"               );
+	c = ezi_realloc(c, 30);          p(c, "c = ezi_realloc(c, 30);"          );
+	ezi_cpy_raw(c, "hello");         p(c, "    ezi_cpy_raw(c,\"hello\");"    );
+	c = ezi_realloc(c, 60);          p(c, "c = ezi_realloc(c, 60);"          );
+	c = ezi_realloc(c, 0);           p(c, "c = ezi_realloc(c, 0);"           );
+	d = ezi_dup_full(a);             p(d, "d = ezi_dup_full(a);"             );
+	e = ezi_dup_part(a);             p(e, "e = ezi_dup_part(a);"             );
+
+	return 0;
+}
+#endif // EZI_ALLOC_TEST_APP
+
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef TEST_APP_EZI_SNPRINTF
+
+#include "alflb.h"
+
+int main ( int argc, char *argv[] )
+{
+	EZI_STR ( medium, 20, "" );
+	EZI_STR ( small , 10, "" );
+
+	ezi_snprintf ( medium, "%s%d%s", "hello", 20, "world" );
+	printf ( "%2lu:%s\n", medium->len, medium->str );
+
+	ezi_snprintf ( small, "%s%d%s", "hello", 20, "world" );
+	printf ( "%2lu:%s\n", small->len, small->str );
+
+	return 0;
+}
+#endif // TEST_APP_EZI_SNPRINTF
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_TEST_APP
+
+#include "alflb.h"
+
+int main(int argc, char *argv[])
+{
+	int       jj;
+#define       P printf
+#define       TMAX 20
+	EZI_STR   (s1, TMAX,    "");
+	EZI_STR   (s2, TMAX,    ".123456789.12345678");
+	EZI_STR   (s3, TMAX,    ".123456789.123456789");
+	EZI_STR   (s4, TMAX + 1,  ".123456789.123456789.");
+	EZI_STR   (non, TMAX,    ".\177\37\377456789.123456789");
+	char      c1[] = ".123456789.12345678";
+	char      c2[] = ".123456789.123456789.12345678";
+#ifdef EZI_TEST_APP_OVERFLOW     // should give at least a warning (would prefer an error)
+	EZI_STR   (over  , TMAX,    ".123456789.123456789.123456789.123456789");
+#endif
+	EZI_STR_T *p1;
+	EZI_STR_T *p2;
+
+	ezi_cpy(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s2)"  , (uint)s1->len, s1->str);
+	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
+	ezi_cpy(s1, s4);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s4)"  , (uint)s1->len, s1->str);
+	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len(recalc)"   , (uint)s1->len, s1->str); // recalc length
+	s1->str[15] = '\0';
+	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len(recalc)"   , (uint)s1->len, s1->str); // recalc length
+	for ( jj = 0; jj < 6; jj++ )
+	{
+	ezi_ch(s1, 'A' + jj);	P("%24.24s=len=%2u \"%s\"\n", "ezi_ch"            , (uint)s1->len, s1->str);
+	}
+	ezi_cpy(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s2)"  , (uint)s1->len, s1->str);
+	ezi_cat(s1, s2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cat(from s2)"  , (uint)s1->len, s1->str);
+	ezi_len(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_len"           , (uint)s1->len, s1->str);
+	ezi_clr(s1);			P("%24.24s=len=%2u \"%s\"\n", "ezi_clr"           , (uint)s1->len, s1->str);
+	ezi_dbg(s1, non);		P("%24.24s=len=%2u \"%s\"\n", "ezi_dbg(from non)" , (uint)s1->len, s1->str); // stops early
+	ezi_esc(non, s1);		P("%24.24s=len=%2u \"%s\"\n", "ezi_esc(from s1)"  , (uint)non->len, non->str);
+	ezi_sproc(non, SP_8BIT_NONP | SP_ONE_BLANK, ' ');
+							P("%24.24s=len=%2u \"%s\"\n", "ezi_sproc(non)"    , (uint)non->len, non->str);
+#ifdef EZI_TEST_APP_OVERFLOW
+	ezi_cpy(s1, over  );	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from over)", (uint)s1->len, s1->str);
+#endif
+	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
+	ezi_ltrim(s1, 2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1, 2)"  , (uint)s1->len, s1->str);
+	ezi_rtrim(s1, 2);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1, 2)"  , (uint)s1->len, s1->str);
+	ezi_ltrim(s1, 999);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1,999)" , (uint)s1->len, s1->str);
+	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
+	ezi_rtrim(s1, 999);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1,999)" , (uint)s1->len, s1->str);
+	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
+	ezi_ltrim(s1, 20);		P("%24.24s=len=%2u \"%s\"\n", "ezi_ltrim(s1,20)"  , (uint)s1->len, s1->str);
+	ezi_cpy(s1, s3);		P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy(from s3)"  , (uint)s1->len, s1->str);
+	ezi_rtrim(s1, 20);		P("%24.24s=len=%2u \"%s\"\n", "ezi_rtrim(s1,20)"  , (uint)s1->len, s1->str);
+	ezi_cpy_raw(s1, c1);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy_raw(from c1)"  , (uint)s1->len, s1->str);
+	ezi_cpy_raw(s1, c2);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cpy_raw(from c2)"  , (uint)s1->len, s1->str);
+	ezi_clr(s1);
+	ezi_cat_raw(s1, c1);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cat_raw(from c1)"  , (uint)s1->len, s1->str);
+	ezi_cat_raw(s1, c2);	P("%24.24s=len=%2u \"%s\"\n", "ezi_cat_raw(from c2)"  , (uint)s1->len, s1->str);
+	p1 = ezi_dup_raw(c1);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "p1=ezi_dup_raw(c1)", (uint)p1->max, (uint)p1->len, p1->str );
+	p2 = ezi_calloc(20);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "p2=ezi_calloc(20)", (uint)p2->max, (uint)p2->len, p2->str );
+	ezi_cpy(p1, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s2)"   , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_cpy(p2, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p2,s2)"   , (uint)p2->max, (uint)p2->len, p2->str );
+p1 = ezi_realloc(p1, 30);	P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_realloc(p1,30)", (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_cpy(p1, s4);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s4)"   , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_cat(p1, s2);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cat(p1,s2)"   , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_cpy(p1, s4);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_cpy(p1,s4)"   , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_reverse(p1);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_reverse(p1)"  , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_trunc(p1, 16);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_trunc(p1,16)" , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_ltrim(p1, 5);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_ltrim(p1,5)"  , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_rtrim(p1, 5);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_rtrim(p1,5)"  , (uint)p1->max, (uint)p1->len, p1->str );
+	ezi_reverse(p1);		P("%24.24s=max=%2u len=%2u \"%s\"\n", "ezi_reverse(p1)"  , (uint)p1->max, (uint)p1->len, p1->str );
+
+	NULLIFY(p1);
+	NULLIFY(p2);
+	return 0;
+}
+#endif // EZI_TEST_APP
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/* Self-checking test programs for the newer functions.  Each prints a line for every check that
+fails, and exits with the number of failures. */
+#if defined(EZI_ESC_TEST_APP) || defined(EZI_UTF8_TEST_APP) || defined(EZI_CASE_TEST_APP) \
+ || defined(EZI_POOL_TEST_APP) || defined(EZI_SORT_TEST_APP) || defined(EZI_NUM_TEST_APP) \
+ || defined(EZI_STRTAB_TEST_APP) || defined(EZI_LOG_TEST_APP) || defined(EZI_REPLACE_TEST_APP) \
+ || defined(EZI_RING_TEST_APP) || defined(EZI_BUILDER_TEST_APP)
+
+static int ezi_test_failures;
+
+#define EZI_CHECK(cond) \
+	do { if ( !(cond) ) { printf("%s:%d: FAILED: %s\n", __FILE__, __LINE__, #cond); ezi_test_failures++; } } while ( 0 )
+
+static inline int ezi_test_is(EZI_STR_T *s, char *expect, size_t expect_len)
+{
+	const char *str = (const char *)s + offsetof(EZI_STR_T, str);  // Not s->str[]: its bound is EZI_DBG_MAX.
+
+	return s->len == expect_len && memcmp(str, expect, expect_len) == 0 && str[s->len] == '\0';
+}
+
+#define EZI_IS(s,literal) ezi_test_is(s, literal, sizeof(literal) - 1ul)
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_ESC_TEST_APP
+
+int main(void)
+{
+	EZI_STR_T *raw  = ezi_calloc(256);
+	EZI_STR_T *text = ezi_calloc(1024);
+	EZI_STR_T *back = ezi_calloc(256);
+	EZI_STR   (small, 6, "");
+	int        b;
+
+	// Every byte, with clean runs long enough for the block copies in between.
+	for ( b = 0; b < 256; b++ )
+		ezi_ch(raw, b);
+	memcpy((char *)raw + offsetof(EZI_STR_T, str) + 40, "a long clean run of text with no escapes", 40);
+
+	ezi_dbg(text, raw);
+	EZI_CHECK(text->len == ezi_dbg_len(raw));
+	EZI_CHECK(ezi_esc_len(text) == raw->len);
+	ezi_esc(back, text);
+	EZI_CHECK(back->len == raw->len && memcmp(back->str, raw->str, raw->len) == 0);
+
+	// In place.
+	ezi_esc(text, text);
+	EZI_CHECK(text->len == raw->len && memcmp(text->str, raw->str, raw->len) == 0);
+
+	ezi_dbg_raw(back, "tab\there\n\"q\"\\\001", 14);
+	EZI_CHECK(EZI_IS(back, "tab\\there\\n\\\"q\\\"\\\\\\001"));
+	ezi_esc_raw(back, "\\x41\\102\\u\\", 11);  // Unknown & dangling escapes are kept.
+	EZI_CHECK(back->str[0] == 'A' && back->str[1] == 'B');
+	ezi_esc_raw(back, "a\\0b\\000", 8);  // NULs come back too.
+	EZI_CHECK(EZI_IS(back, "a\0b\0"));
+
+	// Output never splits an escape sequence, and never passes 'max'.
+	ezi_dbg_raw(small, "abc\001d", 5);
+	EZI_CHECK(EZI_IS(small, "abc"));
+	ezi_dbg_raw(small, "abcdefgh", 8);
+	EZI_CHECK(EZI_IS(small, "abcdef"));
+
+	free(raw);
+	free(text);
+	free(back);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_ESC_TEST_APP
+
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_UTF8_TEST_APP  // Build with -DEZI_UTF8 too.
+
+int main(void)
+{
+	EZI_STR  (s, 8, "");
+	char     euro[] = "\xe2\x82\xac";  // 3 bytes
+	char     bad[]  = "ab\xc3(";
+
+	// A stray continuation byte is dropped, however much room there is.
+	ezi_cpy_raw(s, "ab");
+	ezi_ch(s, 0x80);
+	EZI_CHECK(EZI_IS(s, "ab"));
+	ezi_cpy_raw(s, "abcdef");
+	ezi_ch(s, 0x80);
+	EZI_CHECK(EZI_IS(s, "abcdef"));
+	ezi_ch(s, 0xc3);  // Unless it continues a code point.
+	ezi_ch(s, 0xa9);
+	EZI_CHECK(EZI_IS(s, "abcdef\xc3\xa9"));
+
+	// A lead byte which doesn't fit is dropped, and so is the rest of its code point.
+	ezi_cpy_raw(s, "abcdef");
+	ezi_ch(s, euro[0]);
+	ezi_ch(s, euro[1]);
+	ezi_ch(s, euro[2]);
+	EZI_CHECK(EZI_IS(s, "abcdef"));
+	ezi_cpy_raw(s, "abcde");
+	ezi_ch(s, euro[0]);
+	ezi_ch(s, euro[1]);
+	ezi_ch(s, euro[2]);
+	EZI_CHECK(EZI_IS(s, "abcde\xe2\x82\xac"));
+
+	// Truncation backs off to the last whole code point.
+	ezi_cpy_raw(s, "abcdefg\xe2\x82\xac");
+	EZI_CHECK(EZI_IS(s, "abcdefg"));
+	ezi_cpy_raw(s, "abcd");
+	ezi_cat_raw(s, "\xe2\x82\xac\xe2\x82\xac");
+	EZI_CHECK(EZI_IS(s, "abcd\xe2\x82\xac"));
+	ezi_snprintf(s, "%s%s%s", euro, euro, euro);
+	EZI_CHECK(EZI_IS(s, "\xe2\x82\xac\xe2\x82\xac"));
+
+	EZI_CHECK(ezi_utf8_valid_raw("plain ascii, long enough to use the vector path", 47) == 1);
+	EZI_CHECK(ezi_utf8_valid_raw(bad, 4) == 0);
+	EZI_CHECK(ezi_utf8_valid_raw("\xed\xa0\x80", 3) == 0);  // Surrogate.
+	EZI_CHECK(ezi_utf8_valid_raw("\xc0\xaf", 2) == 0);      // Overlong.
+	EZI_CHECK(ezi_utf8_count_raw("a\xe2\x82\xac" "b\xf0\x9f\x98\x80", 9) == 4);
+	EZI_CHECK(ezi_utf8_cplen(0xf0) == 4 && ezi_utf8_cplen(0x80) == 0);
+	EZI_CHECK(ezi_utf8_cut("ab\xe2\x82", 4) == 2);
+
+#ifdef EZI_SIMD_DISPATCH
+	// The vector validator carries state from block to block: compare it with the C one, with
+	// sequences at every offset, so some straddle a 16-byte boundary or hang off the end.
+	if ( EZI_CPU_SSSE3() )
+	{
+		static const char *const piece[] = {
+			"\xc2\x80", "\xdf\xbf", "\xe0\xa0\x80", "\xed\x9f\xbf", "\xee\x80\x80", "\xef\xbf\xbf",
+			"\xf0\x90\x80\x80", "\xf4\x8f\xbf\xbf",                        // Valid, at the edges.
+			"\xc0\x80", "\xc1\xbf", "\xe0\x9f\xbf", "\xf0\x8f\xbf\xbf",           // Overlong.
+			"\xed\xa0\x80", "\xed\xbf\xbf",                                    // Surrogate.
+			"\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xff",                    // Too large.
+			"\xc2", "\xe2\x82", "\xf0\x9f\x98",                                // Too short.
+			"\x80", "\xbf\xbf", "\xe2\x82\xac\x80", "\xf0\x9f\x98\x80\x80"  // Stray continuations.
+		};
+		char     text[100];
+		size_t   n = sizeof(piece) / sizeof(piece[0]), len, at, k, p, q;
+		int      ok;
+
+		for ( ok = 1, len = 33ul; len <= 64ul; len++ )
+		{
+			for ( p = 0ul; p < n; p++ )
+			{
+				for ( at = 0ul; at + strlen(piece[p]) <= len; at++ )
+				{
+					memset(text, 'a', len);
+					memcpy(&text[at], piece[p], strlen(piece[p]));
+					ok &= ezi_utf8_valid_ssse3(text, len) == ezi_utf8_valid_c(text, len);
+					ok &= ezi_utf8_valid_c(text, len) == (p < 8ul);
+				}
+			}
+		}
+		EZI_CHECK(ok);
+
+		// Random mixes of the pieces, ASCII and any byte at all.
+		srand(4);
+		for ( ok = 1, k = 0ul; k < 200000ul; k++ )
+		{
+			for ( len = 33ul + (size_t)(rand() % 60), at = 0ul; at < len; at += q )
+			{
+				p = (size_t)(rand() % (int)(n + 2ul));
+				q = p < n ? MIN(strlen(piece[p]), len - at) : 1ul;
+				if ( p < n )
+					memcpy(&text[at], piece[p], q);
+				else
+					text[at] = p == n ? 'a' : (char)rand();
+			}
+			ok &= ezi_utf8_valid_ssse3(text, len) == ezi_utf8_valid_c(text, len);
+			ok &= ezi_utf8_valid_raw(text, len) == ezi_utf8_valid_c(text, len);
+		}
+		EZI_CHECK(ok);
+	}
+#endif
+
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_UTF8_TEST_APP
+
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_CASE_TEST_APP
+
+int main(void)
+{
+	EZI_STR_T     *s = ezi_calloc(300);
+	unsigned char  map[256];
+	int            b, n, ok;
+
+	// Every byte, so the vector kernels see all of them and the scalar tail does too.
+	for ( b = 0; b < 256; b++ )
+		ezi_ch(s, b);
+	ezi_upper(s);
+	for ( ok = 1, b = 0; b < 256; b++ )
+		ok &= (unsigned char)s->str[b] == (b >= 'a' && b <= 'z' ? b - 32 : b);
+	EZI_CHECK(ok && s->len == 256);
+	ezi_lower(s);
+	for ( ok = 1, b = 0; b < 256; b++ )
+		ok &= (unsigned char)s->str[b] == (b >= 'A' && b <= 'Z' ? b + 32 : b);
+	EZI_CHECK(ok);
+
+	// A general map (every byte changes: the scalar path) & a sparse one (the pshufb path).
+	for ( b = 0; b < 256; b++ )
+		map[b] = (unsigned char)(255 - b);
+	ezi_translate(s, map);
+	for ( ok = 1, b = 0; b < 256; b++ )
+		ok &= (unsigned char)s->str[b] == 255 - (b >= 'A' && b <= 'Z' ? b + 32 : b);
+	EZI_CHECK(ok);
+
+	// Maps changing 0 to 16 of the groups of 16 bytes, either side of the switch to the C loop.
+	for ( ok = 1, n = 0; n <= 16; n++ )
+	{
+		for ( ezi_clr(s), b = 0; b < 256; b++ )
+		{
+			map[b] = (unsigned char)( (b >> 4) < n ? b * 7 + 3 : b );
+			ezi_ch(s, b);
+		}
+		ezi_translate(s, map);
+		for ( b = 0; b < 256; b++ )
+			ok &= (unsigned char)s->str[b] == map[b];
+	}
+	EZI_CHECK(ok);
+
+	ezi_cpy_raw(s, "Hello, World! 0123456789 hello again, world.");
+	ezi_tr(s, "a-z", "A-Z");
+	EZI_CHECK(EZI_IS(s, "HELLO, WORLD! 0123456789 HELLO AGAIN, WORLD."));
+	ezi_tr(s, "0-9", "#");  // A short to_set repeats its last byte, like tr.
+	EZI_CHECK(EZI_IS(s, "HELLO, WORLD! ########## HELLO AGAIN, WORLD."));
+
+	free(s);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_CASE_TEST_APP
+
+//////////////////////////////////////////////////////////////////////////////////////////
+#ifdef EZI_POOL_TEST_APP  // Build with -DEZI_THREADS -pthread too, to test the threads.
+
+#define N 100000ul
+
+static int misaligned;
+
+static void number(EZI_STR_T *buf, size_t index, void *scratch, void *context)
+{
+	(void)context;
+	if ( ((uintptr_t)scratch & (EZI_POOL_LINE - 1ul)) != 0ul )
+		__atomic_store_n(&misaligned, 1, __ATOMIC_RELAXED);
+	strcpy(scratch, buf->str);  // The worker's own space: buf can't be printed into itself.
+	ezi_snprintf(buf, "%zu:%s", index, (char *)scratch);
+}
+
+int main(void)
+{
+	EZI_POOL_T   *pool = ezi_pool_create(4u, 40ul);  // Scratch is rounded up to a cache line each.
+	EZI_STR_T   **a    = calloc(N, sizeof(EZI_STR_T *));
+	EZI_STR_T   **b    = calloc(N, sizeof(EZI_STR_T *));
+	EZI_STRTAB_T  tab, packed;
+	char          expect[64];
+	size_t        i;
+	int           ok;
+
+	EZI_CHECK(pool != NULL && a != NULL && b != NULL);
+	ezi_strtab_init(&tab);
+	for ( i = 0; i < N; i++ )
+	{
+		a[i] = ezi_calloc(32);
+		b[i] = ezi_calloc(32);
+		ezi_snprintf(a[i], "  rec%zu  ", i);
+		sprintf(expect, "rec%zu", i);
+		ezi_strtab_add_raw(&tab, expect, strlen(expect));
+	}
+
+	ezi_batch_trail(pool, a, N);
+	ezi_batch_cpy(pool, b, a, N);
+	ezi_batch_cat(pool, b, a, N);
+	for ( ok = 1, i = 0; i < N; i++ )
+	{
+		sprintf(expect, "  rec%zu  rec%zu", i, i);  // ezi_trail() only removes trailing spaces.
+		ok &= strcmp(b[i]->str, expect) == 0;
+	}
+	EZI_CHECK(ok);
+
+	// Every result in its own place, whatever thread made it.
+	ezi_batch_apply(pool, a, N, number, NULL);
+	for ( ok = 1, i = 0; i < N; i++ )
+	{
+		sprintf(expect, "%zu:  rec%zu", i, i);
+		ok &= strcmp(a[i]->str, expect) == 0;
+	}
+	EZI_CHECK(ok);
+	EZI_CHECK(!misaligned);
+
+	// From a string table, plain & compressed.
+	ezi_batch_strtab(pool, b, &tab, number, NULL);
+	for ( ok = 1, i = 0; i < N; i++ )
+	{
+		sprintf(expect, "%zu:rec%zu", i, i);
+		ok &= strcmp(b[i]->str, expect) == 0;
+	}
+	EZI_CHECK(ok);
+	EZI_CHECK(ezi_strtab_compress(&packed, &tab) == 0);
+	ezi_batch_strtab(NULL, b, &packed, NULL, NULL);
+	for ( ok = 1, i = 0; i < N; i++ )
+	{
+		sprintf(expect, "rec%zu", i);
+		ok &= strcmp(b[i]->str, expect) == 0;
+	}
+	EZI_CHECK(ok);
+
+	for ( i = 0; i < N; i++ )
+	{
+		free(a[i]);
+		free(b[i]);
+	}
+	free(a);
+	free(b);
+	ezi_strtab_free(&packed);
+	ezi_strtab_free(&tab);
+	ezi_pool_destroy(pool);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_POOL_TEST_APP
+
+#ifdef EZI_SORT_TEST_APP  // Build with -DEZI_THREADS -pthread too, to test the threads.
+
+#define N 200000ul
+
+static int nocase;
+
+static int reference(const void *pa, const void *pb)
+{
+	EZI_STR_T *a = *(EZI_STR_T **)pa, *b = *(EZI_STR_T **)pb;
+	size_t     i, n = MIN(a->len, b->len);
+	int        ca, cb;
+
+	for ( i = 0ul; i < n; i++ )
+	{
+		ca = (unsigned char)a->str[i];
+		cb = (unsigned char)b->str[i];
+		if ( nocase && ca >= 'A' && ca <= 'Z' ) ca += 32;
+		if ( nocase && cb >= 'A' && cb <= 'Z' ) cb += 32;
+		if ( ca != cb )
+			return ca - cb;
+	}
+	return a->len < b->len ? -1 : a->len > b->len;
+}
+
+// Sorts a copy of buf[] both ways, and checks the orders agree (as strings: equal ones may swap).
+static void check(EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags)
+{
+	EZI_STR_T **a = malloc(n * sizeof(EZI_STR_T *));
+	EZI_STR_T **b = malloc(n * sizeof(EZI_STR_T *));
+	size_t      i, unique;
+	int         ok;
+
+	memcpy(a, buf, n * sizeof(EZI_STR_T *));
+	memcpy(b, buf, n * sizeof(EZI_STR_T *));
+	nocase = flags & EZI_SORT_NOCASE;
+	ezi_sort(pool, a, n, flags);
+	qsort(b, n, sizeof(EZI_STR_T *), reference);
+	for ( ok = 1, i = 0ul; i < n; i++ )
+		ok &= reference(&a[i], &b[i]) == 0;
+	EZI_CHECK(ok);
+
+	unique = ezi_sort_unique(pool, a, n, flags);
+	for ( i = 1ul; i < unique; i++ )
+		ok &= reference(&a[i - 1ul], &a[i]) < 0;
+	for ( i = 1ul; i < n; i++ )
+		unique -= reference(&b[i - 1ul], &b[i]) != 0;
+	EZI_CHECK(ok && unique == 1ul);
+	free(a);
+	free(b);
+}
+
+int main(void)
+{
+	EZI_POOL_T  *pool = ezi_pool_create(4u, 0ul);
+	EZI_STR_T  **buf  = calloc(N, sizeof(EZI_STR_T *));
+	EZI_STR_T   *big[2];
+	char        *p;
+	size_t       i, j, len;
+
+	// Few letters, both cases, & often a long shared prefix: deep levels, dups & prefixes of each other.
+	srand(1);
+	for ( i = 0ul; i < N; i++ )
+	{
+		len = (size_t)(rand() % 4 == 0 ? 40 + rand() % 40 : rand() % 12);
+		buf[i] = ezi_calloc(80);
+		for ( j = 0ul; j < len; j++ )
+			ezi_ch(buf[i], j < 32ul && len >= 40ul ? 'x' : "abAB\001"[rand() % 5]);
+	}
+	check(NULL, buf, 1000ul, 0);
+	check(NULL, buf, N, 0);
+	check(NULL, buf, N, EZI_SORT_NOCASE);
+	check(pool, buf, N, 0);
+	check(pool, buf, N, EZI_SORT_NOCASE);
+
+	// Equal strings much longer than the stack could take one level (8 bytes) per call for.
+	for ( i = 0ul; i < 2ul; i++ )
+	{
+		big[i] = ezi_calloc(4000000);
+		memset(big[i]->str, 'z', 4000000ul);
+		big[i]->len = 4000000ul;
+	}
+	ezi_sort(NULL, big, 2ul, 0);
+	EZI_CHECK(ezi_sort_unique(NULL, big, 2ul, 0) == 1ul);
+	p = big[1]->str;
+	p[3999999] = 'y';
+	EZI_CHECK(ezi_sort_unique(pool, big, 2ul, 0) == 2ul && big[0] == (EZI_STR_T *)(p - offsetof(EZI_STR_T, str)));
+
+	for ( i = 0ul; i < N; i++ )
+		free(buf[i]);
+	free(buf);
+	free(big[0]);
+	free(big[1]);
+	ezi_pool_destroy(pool);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_SORT_TEST_APP
+
+#ifdef EZI_NUM_TEST_APP
+
+// The number in 'text' must parse to strtod()'s result, with status 'expect'.
+static void same_as_strtod(const char *text, int expect)
+{
+	double d, want = strtod(text, NULL);
+
+	EZI_CHECK(ezi_view_to_double((EZI_VIEW_T){ (char *)text, strlen(text) }, &d) == expect);
+	if ( memcmp(&d, &want, sizeof(d)) != 0 )
+		printf("%.40s...: %a, strtod() gives %a\n", text, d, want), ezi_test_failures++;
+}
+
+int main(void)
+{
+	static char  text[1200];
+	char        *digits = &text[2 + 323];
+	size_t       i, n = 1ul;
+	uint64_t     u;
+	int64_t      s;
+	uint32_t     h;
+	double       d;
+	unsigned     carry;
+	EZI_STR(buf, 64, "12345,-9,0x1fZ");
+
+	ezi_to_u64(buf, 0, 5, &u);
+	ezi_to_i64(buf, 6, 2, &s);
+	EZI_CHECK(u == 12345ull && s == -9);
+	EZI_CHECK(ezi_hex_to_u32(buf, 9, (size_t)-1, &h) == EZI_NUM_TRAILING && h == 0x1fu);
+	EZI_CHECK(ezi_view_to_u64((EZI_VIEW_T){ "18446744073709551616", 20 }, &u) == EZI_NUM_OVERFLOW && u == UINT64_MAX);
+	EZI_CHECK(ezi_view_to_i64((EZI_VIEW_T){ "-9223372036854775808", 20 }, &s) == EZI_NUM_OK && s == INT64_MIN);
+
+	// Hex digits are ASCII only, in any locale; "0x" needs a digit after it to be a prefix.
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "DEADbeef", 8 }, &h) == EZI_NUM_OK && h == 0xdeadbeefu);
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "0XaB", 4 }, &h) == EZI_NUM_OK && h == 0xabu);
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "0xg", 3 }, &h) == EZI_NUM_TRAILING && h == 0u);
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "0x\xb2", 3 }, &h) == EZI_NUM_TRAILING && h == 0u);
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "g", 1 }, &h) == EZI_NUM_EMPTY);
+	EZI_CHECK(ezi_view_to_hex_u32((EZI_VIEW_T){ "100000000", 9 }, &h) == EZI_NUM_OVERFLOW && h == UINT32_MAX);
+
+	same_as_strtod("0.1", EZI_NUM_OK);
+	same_as_strtod("123456789012345678901234567890", EZI_NUM_OK);
+	same_as_strtod("2.2250738585072011e-308", EZI_NUM_OK);
+	same_as_strtod("4.9406564584124654e-324", EZI_NUM_OK);
+	same_as_strtod("1.7976931348623157e308", EZI_NUM_OK);
+	EZI_CHECK(ezi_view_to_double((EZI_VIEW_T){ "1e309", 5 }, &d) == EZI_NUM_OVERFLOW && isinf(d));
+	EZI_CHECK(ezi_view_to_double((EZI_VIEW_T){ "-Infinity", 9 }, &d) == EZI_NUM_OK && isinf(d) && d < 0.0);
+
+	// 2^-1075 exactly (5^1075 / 10^1075: 752 significant digits), halfway between 0 & the smallest
+	// double.  On its own it rounds to even (0); anything more, however far down, rounds up.
+	digits[0] = 1;
+	for ( i = 0ul; i < 1075ul; i++ )
+	{
+		size_t k;
+
+		for ( carry = 0u, k = n; k-- > 0ul; )
+		{
+			carry    += (unsigned)digits[k] * 5u;
+			digits[k] = (char)(carry % 10u);
+			carry    /= 10u;
+		}
+		if ( carry > 0u )
+		{
+			memmove(&digits[1], digits, n++);
+			digits[0] = (char)carry;
+		}
+	}
+	for ( i = 0ul; i < n; i++ )
+		digits[i] += '0';
+	memcpy(text, "0.", 2);
+	memset(&text[2], '0', 323);
+	EZI_CHECK(n == 752ul && strlen(text) == 1077ul);
+	same_as_strtod(text, EZI_NUM_OK);
+	EZI_CHECK(ezi_view_to_double((EZI_VIEW_T){ text, strlen(text) }, &d) == EZI_NUM_OK && d == 0.0);
+	strcat(text, "0001");
+	same_as_strtod(text, EZI_NUM_OK);
+	EZI_CHECK(ezi_view_to_double((EZI_VIEW_T){ text, strlen(text) }, &d) == EZI_NUM_OK && d == 0x0.0000000000001p-1022);
+
+	// Eisel-Lemire: ties, the edges of the table & of the subnormals, and the Clinger cases beyond it.
+	same_as_strtod("9007199254740993", EZI_NUM_OK);           // 2^53 + 1: a tie, to even.
+	same_as_strtod("9007199254740995", EZI_NUM_OK);
+	same_as_strtod("1e23", EZI_NUM_OK);
+	same_as_strtod("2.4703282292062327e-324", EZI_NUM_OK);   // Just under half the smallest double.
+	same_as_strtod("2.4703282292062328e-324", EZI_NUM_OK);
+	same_as_strtod("9999999999999999999e-343", EZI_NUM_OK);
+	same_as_strtod("17976931348623158e292", EZI_NUM_OK);       // The largest double,
+	same_as_strtod("17976931348623159e292", EZI_NUM_OVERFLOW); // but this rounds up to infinity.
+	same_as_strtod("1.7976931348623157999999e308", EZI_NUM_OK);
+	same_as_strtod("0.000000000000000000000000000000000000001e-300", EZI_NUM_OK);
+
+	// Random numbers of every length & scale, with & without a point.
+	srand(5);
+	for ( n = 0ul; n < 300000ul; n++ )
+	{
+		size_t k, digits = 1ul + (size_t)(rand() % ( rand() % 4 == 0 ? 40 : 19 ));
+		size_t point     = (size_t)(rand() % (int)(digits + 1ul));
+
+		for ( i = 0ul, k = 0ul; k < digits; k++ )
+		{
+			if ( k == point && rand() % 2 )
+				text[i++] = '.';
+			text[i++] = (char)('0' + rand() % 10);
+		}
+		i += (size_t)snprintf(&text[i], 16, "e%d", rand() % 700 - 360);
+		text[i] = '\0';
+		same_as_strtod(text, isinf(strtod(text, NULL)) ? EZI_NUM_OVERFLOW : EZI_NUM_OK);
+	}
+
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_NUM_TEST_APP
+
+#ifdef EZI_STRTAB_TEST_APP
+
+#define PATH "ezi_strtab_test.tab"
+
+// Every string of 'tab' is the same as in 'want', through ezi_strtab_cpy() & ezi_strtab_eq().
+static int same(EZI_STRTAB_T *tab, EZI_STRTAB_T *want, EZI_STR_T *s)
+{
+	size_t i;
+	int    ok = ezi_strtab_count(tab) == ezi_strtab_count(want);
+
+	for ( i = 0ul; ok && i < ezi_strtab_count(want); i++ )
+	{
+		EZI_VIEW_T view = ezi_strtab_get(want, i);
+
+		ezi_strtab_cpy(s, tab, i);
+		ok = s->len == view.len && memcmp(s->str, view.str, view.len) == 0
+		  && ezi_strtab_eq_raw(tab, i, view.str, view.len);
+	}
+	return ok;
+}
+
+int main(void)
+{
+	EZI_STRTAB_T  tab, packed, loaded;
+	EZI_STR_T    *s  = ezi_calloc(70000);
+	char         *db = malloc(65536);
+	char          line[80], *image;
+	size_t        i, a, b;
+	EZI_VIEW_T    view;
+
+	// Plain: views into the table, saved, loaded (read-only) & checked on the way in.
+	ezi_strtab_init(&tab);
+	EZI_CHECK(ezi_strtab_add_raw(&tab, "zero", 4ul) == 0ul && ezi_strtab_add_raw(&tab, "", 0ul) == 1ul);
+	for ( i = 2ul; i < 1000ul; i++ )
+	{
+		sprintf(line, "string %zu", i);
+		EZI_CHECK(ezi_strtab_add_raw(&tab, line, strlen(line)) == i);
+	}
+	view = ezi_strtab_get(&tab, 0ul);
+	EZI_CHECK(view.len == 4ul && strcmp(view.str, "zero") == 0);
+	view = ezi_strtab_get(&tab, 1000ul);
+	EZI_CHECK(view.str == NULL && view.len == 0ul && ezi_strtab_get(&tab, 1ul).str != NULL);
+	EZI_CHECK(ezi_strtab_save(&tab, PATH) == 0 && ezi_strtab_load(&loaded, PATH) == 0);
+	EZI_CHECK(same(&loaded, &tab, s) && strcmp(ezi_strtab_get(&loaded, 999ul).str, "string 999") == 0);
+	EZI_CHECK(ezi_strtab_add_raw(&loaded, "more", 4ul) == EZI_STRTAB_FAIL && ezi_strtab_count(&loaded) == 1000ul);
+	{
+		EZI_STR(small, 4, "");
+
+		EZI_CHECK(strcmp(ezi_strtab_cpy(small, &loaded, 999ul)->str, "stri") == 0);
+	}
+
+	image = malloc(loaded.image_size);
+	memcpy(image, loaded.image, loaded.image_size);
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, loaded.image_size) == 0 && same(&packed, &tab, s));
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, 63ul) != 0);                      // No room for the header.
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, loaded.image_size - 1ul) != 0);   // Data cut short.
+	image[offsetof(EZI_STRTAB_FILE_T, endian)] ^= 1;                                  // Other byte order.
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, loaded.image_size) != 0);
+	image[offsetof(EZI_STRTAB_FILE_T, endian)] ^= 1;
+	image[0] = 'X';                                                                   // Not a table.
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, loaded.image_size) != 0);
+	image[0] = 'E';
+	EZI_CHECK(ezi_strtab_from_image(&packed, image, loaded.image_size) == 0);
+	packed.data[4] = 'X';                                                             // "zero" not terminated.
+	EZI_CHECK(ezi_strtab_get(&packed, 0ul).str == NULL && ezi_strtab_get(&packed, 2ul).str != NULL);
+	EZI_CHECK(ezi_strtab_cpy(s, &packed, 0ul)->len == 0ul && !ezi_strtab_eq_raw(&packed, 0ul, "zeroX", 5ul));
+	free(image);
+	image = malloc(loaded.image_size + 1ul);                                          // Misaligned.
+	memcpy(&image[1], loaded.image, loaded.image_size);
+	EZI_CHECK(ezi_strtab_from_image(&packed, &image[1], loaded.image_size) != 0);
+	free(image);
+	ezi_strtab_free(&loaded);
+	ezi_strtab_free(&tab);
+
+	// Compressed: every string comes back, & takes less room than plain.
+	ezi_strtab_init(&tab);
+	for ( i = 0ul; i < 20000ul; i++ )
+	{
+		sprintf(line, "https://www.example.com/catalogue/item/%zu?ref=search&page=%zu", i * 7919ul, i % 13ul);
+		ezi_strtab_add_raw(&tab, line, strlen(line));
+	}
+	ezi_strtab_add_raw(&tab, "", 0ul);
+	ezi_strtab_add_raw(&tab, "\xff\x00\x01 bytes no symbol has", 24ul);
+	EZI_CHECK(ezi_strtab_compress(&packed, &tab) == 0);
+	EZI_CHECK(packed.data_size < tab.data_size / 2ul);
+	EZI_CHECK(same(&packed, &tab, s));
+	EZI_CHECK(ezi_strtab_get(&packed, 0ul).str == NULL);
+	EZI_CHECK(ezi_strtab_compress(&loaded, &packed) == -1);  // Not twice.
+
+	ezi_cpy_raw(s, "https://www.example.com/catalogue/item/0?ref=search&page=");
+	EZI_CHECK(ezi_strtab_prefix(&packed, 0ul, s) && ezi_strtab_prefix_raw(&packed, 13ul, s->str, 39ul));
+	EZI_CHECK(!ezi_strtab_eq(&packed, 0ul, s) && !ezi_strtab_prefix(&packed, 1ul, s));
+	EZI_CHECK(ezi_strtab_eq_raw(&packed, 0ul, "https://www.example.com/catalogue/item/0?ref=search&page=0", 58ul));
+	EZI_CHECK(!ezi_strtab_eq_raw(&packed, 0ul, "https://www.example.com/catalogue/item/0?ref=search&page=1", 58ul));
+	EZI_CHECK(!ezi_strtab_eq_raw(&packed, 0ul, "https://www.example.com/catalogue/item/0?ref=search&page=00", 59ul));
+	EZI_CHECK(ezi_strtab_prefix_raw(&packed, 20000ul, "", 0ul) && ezi_strtab_eq_raw(&packed, 20000ul, "", 0ul));
+	EZI_CHECK(!ezi_strtab_prefix_raw(&packed, 20000ul, "h", 1ul));
+
+	// Added later, with the same symbols.
+	EZI_CHECK(ezi_strtab_add_raw(&packed, "https://www.example.com/", 24ul) == 20002ul);
+	ezi_strtab_add_raw(&tab, "https://www.example.com/", 24ul);
+	EZI_CHECK(same(&packed, &tab, s));
+
+	// Saved & loaded, compressed.
+	EZI_CHECK(ezi_strtab_save(&packed, PATH) == 0 && ezi_strtab_load(&loaded, PATH) == 0);
+	EZI_CHECK(same(&loaded, &tab, s));
+	ezi_strtab_free(&loaded);
+	ezi_strtab_free(&packed);
+	ezi_strtab_free(&tab);
+
+	// Every byte pair once (a de Bruijn sequence), so every pair is a candidate symbol: two samples
+	// of nearly 32KB used to overrun the candidates.
+	for ( i = 0ul, a = 0ul; a < 256ul; a++ )
+	{
+		db[i++] = (char)a;
+		for ( b = a + 1ul; b < 256ul; b++ )
+		{
+			db[i++] = (char)a;
+			db[i++] = (char)b;
+		}
+	}
+	ezi_strtab_init(&tab);
+	ezi_strtab_add_raw(&tab, db, 32767ul);
+	ezi_strtab_add_raw(&tab, "a", 1ul);
+	ezi_strtab_add_raw(&tab, "b", 1ul);
+	ezi_strtab_add_raw(&tab, &db[32767], 32767ul);
+	EZI_CHECK(ezi_strtab_compress(&packed, &tab) == 0);
+	EZI_CHECK(same(&packed, &tab, s));
+	ezi_strtab_free(&packed);
+	ezi_strtab_free(&tab);
+
+	remove(PATH);
+	free(db);
+	free(s);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_STRTAB_TEST_APP
+
+#ifdef EZI_LOG_TEST_APP  // Build with -DEZI_THREADS -pthread too, to test the background thread.
+
+#define THREADS 4
+#define LINES   2000
+
+// What the log holds since 'at', and where it ends.
+static size_t file_text(int fd, size_t at, EZI_STR_T *to)
+{
+	ssize_t n;
+
+	to->len = 0ul;
+	while ( to->len < to->max && (n = pread(fd, &to->str[to->len], to->max - to->len, (off_t)(at + to->len))) > 0 )
+		to->len += (size_t)n;
+	to->str[to->len] = '\0';
+	return at + to->len;
+}
+
+#ifdef EZI_THREADS
+static EZI_LOG_T *shared;
+
+static void *writer(void *arg)
+{
+	int i, t = (int)(intptr_t)arg;
+
+	for ( i = 0; i < LINES; i++ )
+		ezi_log(shared, "thread %d line %d\n", t, i);
+	return NULL;
+}
+#endif
+
+int main(void)
+{
+	FILE            *fp     = tmpfile();
+	int              fd     = fileno(fp);
+	EZI_STR_T       *got    = ezi_calloc(1000000);
+	EZI_STR_T       *expect = ezi_calloc(1000000);
+	static char      big[2001];
+	EZI_LOG_STATS_T  st;
+	EZI_LOG_T       *log;
+	size_t           at = 0ul, i;
+	int              t, line[THREADS], ok;
+
+	EZI_CHECK(ezi_log_create(fd, 1000ul, 100ul, EZI_LOG_BLOCK) == NULL);   // Not a power of two ...
+	EZI_CHECK(ezi_log_create(fd, 512ul, 100ul, EZI_LOG_BLOCK) == NULL);    // ... or too small for a record.
+	log = ezi_log_create(fd, 4096ul, 100ul, EZI_LOG_BLOCK);
+	EZI_CHECK(log != NULL);
+
+	// Formatted later, the same as now.
+	memset(big, 'w', sizeof(big) - 1ul);
+	big[sizeof(big) - 1ul] = '\0';
+	ezi_log(log, "%d %u %x %ld %lld %zu %hhd %hd %c|%s|%p %% %5.2f %-8s| %*d %.*s\n",
+	        -1, 2u, 0xabu, -3l, 4ll, (size_t)5, (signed char)-6, (short)7, 'c', "str", (void *)&at, 3.14159,
+	        "left", 6, 42, 3, "abcdef");
+	ezi_log(log, "%e %g %Lg %a %jd %td %s\n", 1e-300, 0.5, 1.25L, 1.0, (intmax_t)-8, (ptrdiff_t)9, "");
+	ezi_log(log, "cut: %s\n", big);                      // Longer than a line: truncated.
+	EZI_CHECK(ezi_log(log, "%s %d\n", big, 5) == 0);     // Cut short to leave room for the %d.
+	EZI_CHECK(ezi_log(log, "%.20s %d %s %d\n", big, 1, big, 2) == 0);
+	ezi_log(log, "a=%d b=%1$d %d\n", 5, 6);             // Positional: the rest is written as it is.
+	ezi_log_flush(log);
+	ezi_snprintf(expect, "%d %u %x %ld %lld %zu %hhd %hd %c|%s|%p %% %5.2f %-8s| %*d %.*s\n",
+	             -1, 2u, 0xabu, -3l, 4ll, (size_t)5, (signed char)-6, (short)7, 'c', "str", (void *)&at, 3.14159,
+	             "left", 6, 42, 3, "abcdef");
+	ezi_snprintf(got, "%e %g %Lg %a %jd %td %s\n", 1e-300, 0.5, 1.25L, 1.0, (intmax_t)-8, (ptrdiff_t)9, "");
+	ezi_cat(expect, got);
+	ezi_snprintf(got, "cut: %s\n", big);
+	ezi_trunc(got, 100ul);
+	ezi_cat(expect, got);
+	ezi_snprintf(got, "%s %d\n", big, 5);
+	ezi_trunc(got, 100ul);
+	ezi_cat(expect, got);
+	ezi_snprintf(got, "%.20s %d %s %d\n", big, 1, big, 2);
+	ezi_trunc(got, 100ul);
+	ezi_cat(expect, got);
+	ezi_cat_raw(expect, "a=5 b=%1$d %d\n");
+	at = file_text(fd, at, got);
+	EZI_CHECK(got->len == expect->len && memcmp(got->str, expect->str, got->len) == 0);
+	ezi_log_stats(log, &st);
+	EZI_CHECK(st.recorded == 6ull && st.formatted == 6ull && st.dropped == 0ull && st.written == got->len);
+
+	// Every thread's lines, in its own order: none lost when blocking.
+#ifdef EZI_THREADS
+	{
+		pthread_t tid[THREADS];
+
+		shared = log;
+		for ( t = 0; t < THREADS; t++ )
+			pthread_create(&tid[t], NULL, writer, (void *)(intptr_t)t);
+		for ( t = 0; t < THREADS; t++ )
+			pthread_join(tid[t], NULL);
+	}
+#else
+	for ( i = 0ul; i < (size_t)LINES * THREADS; i++ )
+		ezi_log(log, "thread %d line %d\n", (int)(i % THREADS), (int)(i / THREADS));
+#endif
+	ezi_log_flush(log);
+	at = file_text(fd, at, got);
+	memset(line, 0, sizeof(line));
+	for ( ok = 1, i = 0ul; ok && i < got->len; i = (size_t)(strchr(&got->str[i], '\n') - got->str) + 1ul )
+	{
+		int n;
+
+		ok = sscanf(&got->str[i], "thread %d line %d", &t, &n) == 2 && t >= 0 && t < THREADS && n == line[t]++;
+	}
+	for ( t = 0; t < THREADS; t++ )
+		ok &= line[t] == LINES;
+	EZI_CHECK(ok);
+	ezi_log_destroy(log);
+
+	// Dropping: every record is either written or counted as dropped.
+	log = ezi_log_create(fd, 4096ul, 100ul, EZI_LOG_DROP);
+	for ( i = 0ul; i < 100000ul; i++ )
+		ezi_log(log, "%zu\n", i);
+	ezi_log_flush(log);
+	ezi_log_stats(log, &st);
+	at = file_text(fd, at, got);
+	for ( t = 0, i = 0ul; i < got->len; i++ )
+		t += got->str[i] == '\n';
+	EZI_CHECK(st.recorded + st.dropped == 100000ull && st.formatted == st.recorded && (uint64_t)t == st.recorded);
+	ezi_log_destroy(log);
+
+	fclose(fp);
+	free(got);
+	free(expect);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_LOG_TEST_APP
+
+#ifdef EZI_REPLACE_TEST_APP
+
+#include <fnmatch.h>
+
+// The plain way: every 'find' (or the first), into a big buffer, then cut to 'max'.
+static size_t reference(char *out, size_t max, const char *from, const char *find, const char *with, int all)
+{
+	size_t n = 0ul, find_len = strlen(find), with_len = strlen(with);
+	int    done = 0;
+
+	while ( *from != '\0' )
+	{
+		if ( find_len > 0ul && !done && strncmp(from, find, find_len) == 0 )
+		{
+			memcpy(&out[n], with, with_len);
+			n    += with_len;
+			from += find_len;
+			done  = !all;
+		}
+		else
+			out[n++] = *from++;
+	}
+	return MIN(n, max);
+}
+
+int main(void)
+{
+	EZI_STR_T  *a = ezi_calloc(40), *b = ezi_calloc(40);
+	EZI_GLOB_T *glob;
+	char        text[16], find[4], with[8], pattern[12], want[400];
+	size_t      i, k, n, max;
+	int         all, ok;
+	EZI_STR(small, 10, "");
+
+	ezi_cpy_raw(a, "the cat sat on the mat");
+	EZI_CHECK(EZI_IS(ezi_replace_raw(b, a, "at", "og"), "the cog sat on the mat"));
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, a, "at", "og"), "the cog sog on the mog"));
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, a, "the ", ""), "cat sat on mat"));
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, a, "", "x"), "the cat sat on the mat"));
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(small, a, "at", "og"), "the cog so"));  // Truncated like ezi_cpy().
+	ezi_cpy_raw(b, "aaaa");
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, b, "aa", "a"), "aa"));                 // Not overlapping.
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, b, "a", "<a>"), "<a><a>"));            // In place, growing.
+	EZI_CHECK(EZI_IS(ezi_replace_all_raw(b, b, "<a>", "a"), "aa"));                // Back again.
+
+	// Round trips at every size of 'to', copied & in place, against the plain way.
+	srand(2);
+	for ( ok = 1, i = 0ul; ok && i < 200000ul; i++ )
+	{
+		for ( n = (size_t)(rand() % 15), k = 0ul; k < n; k++ )
+			text[k] = "ab"[rand() % 2];
+		text[n] = '\0';
+		for ( n = (size_t)(rand() % 3), k = 0ul; k < n; k++ )
+			find[k] = "ab"[rand() % 2];
+		find[n] = '\0';
+		for ( n = (size_t)(rand() % 6), k = 0ul; k < n; k++ )
+			with[k] = "abc"[rand() % 3];
+		with[n] = '\0';
+		all = rand() % 2;
+		max = (size_t)(rand() % 40);
+
+		n = reference(want, max, text, find, with, all);
+		b->max = max;
+		ezi_cpy_raw(a, text);
+		all ? ezi_replace_all_raw(b, a, find, with) : ezi_replace_raw(b, a, find, with);
+		ok = b->len == n && memcmp(b->str, want, n) == 0 && b->str[n] == '\0' && strcmp(a->str, text) == 0;
+		if ( ok && strlen(text) <= max )
+		{
+			a->max = max;
+			all ? ezi_replace_all_raw(a, a, find, with) : ezi_replace_raw(a, a, find, with);
+			ok = a->len == n && memcmp(a->str, want, n) == 0 && a->str[n] == '\0';
+		}
+		if ( !ok )
+			printf("\"%s\" \"%s\" -> \"%s\" (all %d, max %zu)\n", text, find, with, all, max);
+		a->max = 40ul;
+	}
+	b->max = 40ul;
+	EZI_CHECK(ok);
+
+	// ezi_overlay_raw() only as far as the buffer goes.
+	ezi_cpy_raw(small, "0123456789");
+	EZI_CHECK(EZI_IS(ezi_overlay_raw(small, 8ul, "abcd", 4ul), "01234567ab"));
+	EZI_CHECK(EZI_IS(ezi_overlay_raw(small, 2ul, "xy", 2ul), "01xy4567ab"));
+	ezi_trunc(small, 3ul);
+	EZI_CHECK(EZI_IS(ezi_overlay_raw(small, 4ul, "xy", 2ul), "01x"));  // Past the end: unchanged.
+
+	// Globs: a few by hand, then the same answers as fnmatch() for lots of small patterns.
+	glob = ezi_glob_compile("*.[ch]");
+	EZI_CHECK(ezi_glob_match_raw(glob, "ezi_str.c", 9ul) && ezi_glob_match_raw(glob, ".h", 2ul));
+	EZI_CHECK(!ezi_glob_match_raw(glob, "ezi_str.o", 9ul) && !ezi_glob_match_raw(glob, "c", 1ul));
+	ezi_glob_free(glob);
+	glob = ezi_glob_compile("a*b*a");
+	ezi_cpy_raw(a, "abba");
+	EZI_CHECK(ezi_glob_match(glob, a) && !ezi_glob_match_raw(glob, "aba b", 5ul));
+	ezi_glob_free(glob);
+	glob = ezi_glob_compile("\\*[!0-9]?");
+	EZI_CHECK(ezi_glob_match_raw(glob, "*ab", 3ul) && !ezi_glob_match_raw(glob, "*1b", 3ul));
+	ezi_glob_free(glob);
+
+	for ( ok = 1, i = 0ul; ok && i < 200000ul; i++ )
+	{
+		for ( n = (size_t)(rand() % 10), k = 0ul; k < n; k++ )
+			pattern[k] = "ab*?[]!-\\"[rand() % 9];
+		pattern[n] = '\0';
+		if ( n > 0ul && pattern[n - 1ul] == '\\' )  // fnmatch() fails an escape of nothing.
+			pattern[n - 1ul] = 'a';
+		for ( n = (size_t)(rand() % 8), k = 0ul; k < n; k++ )
+			text[k] = "ab-]!*\\"[rand() % 7];
+		text[n] = '\0';
+
+		glob = ezi_glob_compile(pattern);
+		ok = ezi_glob_match_raw(glob, text, n) == (fnmatch(pattern, text, 0) == 0);
+		if ( !ok )
+			printf("pattern \"%s\", text \"%s\"\n", pattern, text);
+		ezi_glob_free(glob);
+	}
+	EZI_CHECK(ok);
+
+	free(a);
+	free(b);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_REPLACE_TEST_APP
+
+#ifdef EZI_RING_TEST_APP  // Build with -DEZI_THREADS -pthread too, to test a producer & consumer thread.
+
+#define BYTES 1000000ul
+
+#ifdef EZI_THREADS
+static EZI_RING_T *shared;
+
+// Pushes bytes i % 251 for i = 0 .. BYTES-1, as fast as there is room.
+static void *producer(void *arg)
+{
+	char   chunk[97];
+	size_t i = 0ul, n, k;
+
+	(void)arg;
+	while ( i < BYTES )
+	{
+		for ( n = MIN(sizeof(chunk), BYTES - i), k = 0ul; k < n; k++ )
+			chunk[k] = (char)((i + k) % 251ul);
+		if ( (n = ezi_ring_push_raw(shared, chunk, n)) == 0ul )
+			sched_yield();  // Full: let the consumer run, even on one CPU.
+		i += n;
+	}
+	return NULL;
+}
+#endif
+
+int main(void)
+{
+	EZI_STR_T  *buf = ezi_calloc(16), *line = ezi_calloc(8);
+	EZI_HEAD_T  h;
+	EZI_VIEW_T  view;
+	char        out[64], model[64];
+	size_t      i, n, used = 0ul, start = 0ul;
+	int         ok;
+	EZI_RING  (ring, 16, 0);
+
+	// Head: trimming is only an offset, until an append needs the room.
+	ezi_head_init(&h, buf);
+	ezi_head_cat_raw(&h, "0123456789", 10ul);
+	ezi_head_ltrim(&h, 4ul);
+	view = ezi_head_view(&h);
+	EZI_CHECK(h.head == 4ul && view.len == 6ul && memcmp(view.str, "456789", 6ul) == 0);
+	ezi_head_cat_raw(&h, "abcdef", 6ul);         // Fits after the string: nothing moves.
+	EZI_CHECK(h.head == 4ul && ezi_head_len(&h) == 12ul);
+	ezi_head_cat_raw(&h, "ghijkl", 6ul);         // Doesn't: moved to the front, then truncated.
+	EZI_CHECK(h.head == 0ul && EZI_IS(buf, "456789abcdefghij"));
+	ezi_head_ltrim(&h, 10ul);
+	EZI_CHECK(EZI_IS(ezi_head_compact(&h), "efghij") && h.head == 0ul);
+	ezi_head_ltrim(&h, 100ul);
+	EZI_CHECK(ezi_head_len(&h) == 0ul && buf->len == 0ul && h.head == 0ul);
+
+	// Ring: pushes & pops of every size round & round the buffer, against a plain FIFO.
+	EZI_CHECK(ezi_ring_init(&(EZI_RING_T){ 0 }, out, 12ul, 0) == NULL);
+	srand(3);
+	for ( ok = 1, i = 0ul; ok && i < 100000ul; i++ )
+	{
+		n = (size_t)(rand() % 20);
+		if ( rand() % 2 )
+		{
+			char in[20];
+			size_t k, pushed;
+
+			for ( k = 0ul; k < n; k++ )
+				in[k] = (char)rand();
+			pushed = ezi_ring_push_raw(ring, in, n);
+			ok = pushed == MIN(n, 16ul - used);
+			memcpy(&model[start + used], in, pushed);
+			used += pushed;
+		}
+		else
+		{
+			view = ezi_ring_peek_view(ring);
+			ok = view.len > 0ul || used == 0ul;
+			n = ezi_ring_pop_raw(ring, out, n);
+			ok &= n == MIN(n, used) && memcmp(out, &model[start], n) == 0;
+			start += n;
+			used  -= n;
+		}
+		ok &= ezi_ring_used(ring) == used && ezi_ring_room(ring) == 16ul - used;
+		memmove(model, &model[start], used);
+		start = 0ul;
+	}
+	EZI_CHECK(ok);
+
+	// Lines: CR LF or LF, cut to the string, and a full ring with no end of line is a line.
+	ezi_ring_consume(ring, ezi_ring_used(ring));
+	ezi_ring_push_raw(ring, "one\r\ntwo\nthr", 12ul);
+	EZI_CHECK(EZI_IS(ezi_ring_pop_line(ring, line), "one") && EZI_IS(ezi_ring_pop_line(ring, line), "two"));
+	EZI_CHECK(ezi_ring_pop_line(ring, line) == NULL && ezi_ring_used(ring) == 3ul);
+	ezi_ring_push_raw(ring, "ee and more!", 12ul);
+	EZI_CHECK(ezi_ring_used(ring) == 15ul && ezi_ring_pop_line(ring, line) == NULL);
+	ezi_ring_push_raw(ring, "?", 1ul);
+	EZI_CHECK(EZI_IS(ezi_ring_pop_line(ring, line), "three an") && ezi_ring_used(ring) == 0ul);
+
+#ifdef EZI_THREADS
+	{
+		EZI_RING   (spsc, 1024, EZI_RING_SPSC);
+		pthread_t  tid;
+		char       chunk[61];
+		size_t     k;
+
+		shared = spsc;
+		pthread_create(&tid, NULL, producer, NULL);
+		for ( ok = 1, i = 0ul; i < BYTES; i += n )
+		{
+			if ( (n = ezi_ring_pop_raw(spsc, chunk, sizeof(chunk))) == 0ul )
+				sched_yield();
+			for ( k = 0ul; k < n; k++ )
+				ok &= (unsigned char)chunk[k] == (i + k) % 251ul;
+		}
+		pthread_join(tid, NULL);
+		EZI_CHECK(ok && ezi_ring_used(spsc) == 0ul);
+	}
+#endif
+
+	free(buf);
+	free(line);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_RING_TEST_APP
+
+#ifdef EZI_BUILDER_TEST_APP  // Build with -DEZI_UTF8 too, for its truncation rules.
+
+int main(void)
+{
+	EZI_STR_T     *built = ezi_calloc(64), *plain = ezi_calloc(64), *piece = ezi_calloc(16);
+	EZI_BUILDER_T  b;
+	char           raw[16];
+	size_t         i, k, n, max;
+	int            op, ok;
+
+	// The same as the equivalent ezi_ch(), ezi_cat() & ezi_cat_raw() calls, at every size.
+	static const char *const bits[] = { "a", "bc", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\x80", "\xff" };
+	srand(4);
+	for ( ok = 1, i = 0ul; ok && i < 200000ul; i++ )
+	{
+		max = (size_t)(rand() % 24);
+		built->max = plain->max = max;
+		ezi_clr(built);
+		ezi_clr(plain);
+		if ( rand() % 2 )  // Appending after what's there.
+		{
+			ezi_cpy_raw(built, "pre");
+			ezi_cpy_raw(plain, "pre");
+		}
+		ezi_builder_init(&b, built);
+		for ( k = (size_t)(rand() % 8); k > 0ul; k-- )
+		{
+			for ( raw[0] = '\0', n = 1ul + (size_t)(rand() % 2); n > 0ul; n-- )  // No '\0': ezi_cat_raw() would stop there.
+				strcat(raw, bits[rand() % 7]);
+			op = rand() % 3;
+			if ( op == 0 )
+			{
+				ezi_builder_put_ch(&b, (unsigned char)raw[0]);
+				ezi_ch(plain, (unsigned char)raw[0]);
+			}
+			else if ( op == 1 )
+			{
+				ezi_cpy_raw(piece, raw);
+				ezi_builder_put_str(&b, piece);
+				ezi_cat(plain, piece);
+			}
+			else
+			{
+				ezi_builder_put_raw(&b, raw);
+				ezi_cat_raw(plain, raw);
+			}
+		}
+		ezi_builder_finish(&b);
+		ok = built->len == plain->len && strcmp(built->str, plain->str) == 0;
+	}
+	built->max = plain->max = 64ul;
+	EZI_CHECK(ok);
+
+	// Put past the end: truncated, & flagged.
+	ezi_clr(built);
+	built->max = 4ul;
+	ezi_builder_init(&b, built);
+	ezi_builder_put_raw(&b, "abc");
+	EZI_CHECK(!b.truncated);
+	ezi_builder_put_raw(&b, "de");
+	ezi_builder_put_ch(&b, 'f');
+	EZI_CHECK(b.truncated && EZI_IS(ezi_builder_finish(&b), "abcd"));
+
+	// Started past max (after max was lowered): cut to max, as ezi_ch() would.
+	ezi_cpy_raw(built, "abcdef");
+	ezi_cpy_raw(plain, "abcdef");
+	built->max = plain->max = 4ul;
+	ezi_builder_init(&b, built);
+	ezi_builder_put_ch(&b, 'g');
+	ezi_ch(plain, 'g');
+	EZI_CHECK(b.truncated && EZI_IS(ezi_builder_finish(&b), "abcd") && EZI_IS(plain, "abcd"));
+	built->max = plain->max = 64ul;
+
+	// put_str() copies all of from->len.
+	memcpy(piece->str, "a\0b", 4);
+	piece->len = 3ul;
+	ezi_clr(built);
+	ezi_builder_put_str(ezi_builder_init(&b, built), piece);
+	EZI_CHECK(!b.truncated && EZI_IS(ezi_builder_finish(&b), "a\0b"));
+
+	free(built);
+	free(plain);
+	free(piece);
+	printf("%d failure(s)\n", ezi_test_failures);
+	return ezi_test_failures;
+}
+#endif // EZI_BUILDER_TEST_APP
 
 // End-Of-File
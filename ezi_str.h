@@ -23,6 +23,23 @@ Refer to alflb documentation which contains usage notes for these and other func
 
 ----------------------------------------------------------------------------------------------------
 
+20261019 abb Added ezi_dbg(), ezi_esc() & their _raw and _len variants to ezi_str.c.
+20261019 abb Added the UTF-8 helpers ezi_utf8_valid(), ezi_utf8_count(), ezi_utf8_cplen() &
+             ezi_utf8_cut().  Build with EZI_UTF8 to make truncation UTF-8 aware.
+20261019 abb Added ezi_upper(), ezi_lower(), ezi_translate() & ezi_tr().
+20261019 abb Added EZI_POOL_T & ezi_pool_xxx() (threaded with EZI_THREADS), and ezi_batch_xxx().
+20261019 abb Added ezi_sort() & ezi_sort_unique().
+20261019 abb Added EZI_VIEW_T, EZI_HEAD_T & ezi_head_xxx(), and EZI_RING(), EZI_RING_T &
+             ezi_ring_xxx().
+20261019 abb Added EZI_BUILDER_T & the inline ezi_builder_xxx() functions.
+20261019 abb Added ezi_to_i64(), ezi_to_u64(), ezi_to_double(), ezi_hex_to_u32() & their _view
+             forms, with the EZI_NUM_xxx results.
+20261019 abb Added EZI_STRTAB_T & ezi_strtab_xxx().
+20261019 abb Added ezi_strtab_compress(), ezi_strtab_eq() & ezi_strtab_prefix().
+20261019 abb Added EZI_LOG_T, EZI_LOG_STATS_T & ezi_log_xxx(), where EZI_POSIX is defined.
+20261019 abb Added ezi_replace(), ezi_replace_all() & their _raw variants, and EZI_GLOB_T &
+             ezi_glob_xxx().
+20261019 abb Added ezi_batch_strtab().
 20220507 abb Extracted ezi_str definitions to this header file.
 20180208 abb Renamed max in the ezi strings to max_index, although the public name 'max' is unchanged.
 20161120 abb Used stdint types (e.g. uint32_t) instead of ULONG, etc.
@@ -58,6 +75,11 @@ Refer to alflb documentation which contains usage notes for these and other func
 #include <stdarg.h>     // for va_list
 #include <stdio.h>      // for FILE*
 #include <stdint.h>     // for various types                                              //20160129
+#include <string.h>     // for memcpy() in the inline ezi_builder_xxx()
+
+#if !defined(EZI_POSIX) && (defined(__unix__) || defined(__APPLE__))
+#define EZI_POSIX 1     // write(), mmap() & clock_gettime(): for ezi_log_xxx() & ezi_strtab_load()
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -133,6 +155,82 @@ EZI_STR(name,max_index,init_str)  Initialised ezi string. The created object is
 
 	typedef         EZI_STR_PRIVATE(ezistr, EZI_DBG_MAX) EZI_STR_T; // TYPICALLY USED ONLY FOR PROTOTYPES, 'extern' REFERENCES OR POINTERS.
 
+/***************************************************************************************************
+  EZI_VIEW_T                     A read-only look at 'len' bytes somewhere else, e.g. inside an Ezi
+                                 string.  Not necessarily '\0'-terminated.
+
+  EZI_HEAD_T                     An Ezi string whose front can be trimmed in O(1): the string is
+                                 buf->str[head .. buf->len).  See ezi_head_xxx().
+
+  EZI_RING(name,size_pow2,flags) Byte FIFO with its buffer.  Like EZI_STR(), the created object is a
+                                 pointer.  flags: 0, or EZI_RING_SPSC for a lock-free single
+                                 producer/single consumer (e.g. ISR to task, or thread to thread).
+                                 A size which isn't a power of 2 doesn't compile, nor does
+                                 EZI_RING_SPSC with a compiler which has no GCC-style atomics.
+***************************************************************************************************/
+
+	typedef struct
+	{
+		char   *str;
+		size_t  len;
+	} EZI_VIEW_T;
+
+	typedef struct
+	{
+		EZI_STR_T *buf;
+		size_t     head;
+	} EZI_HEAD_T;
+
+	typedef struct
+	{
+		char   *buf;
+		size_t  size;  // A power of 2.
+		size_t  head;  // Total bytes consumed: written by the consumer only.
+		size_t  tail;  // Total bytes pushed: written by the producer only.
+		int     flags;
+	} EZI_RING_T;
+
+#define EZI_RING_SPSC 1
+
+/***************************************************************************************************
+  EZI_STRTAB_T                   Packed, append-only table of strings: one block of bytes and an
+                                 index, instead of an allocated Ezi string each.  Can be saved to a
+                                 file which ezi_strtab_load() maps and uses without parsing.  The
+                                 fields are private: use the ezi_strtab_xxx() functions.
+***************************************************************************************************/
+
+	typedef struct
+	{
+		char     *data;        // Every string, each followed by '\0'.
+		uint64_t *offset;      // count + 1 of them: string i is data[offset[i] .. offset[i+1] - 1).
+		size_t    count;
+		size_t    data_size;
+		size_t    data_cap;
+		size_t    index_cap;
+		void     *image;       // A loaded file, else NULL.
+		size_t    image_size;
+		int       mapped;      // image was mmap()'d ...
+		int       owned;       // ... or malloc()'d.
+		struct ezi_symtab_struct_tag *symtab;  // Compressed, else NULL.
+	} EZI_STRTAB_T;
+
+	typedef struct ezi_symtab_struct_tag EZI_SYMTAB_T;
+
+#define EZI_STRTAB_FAIL ((size_t)-1)
+
+// The size of EZI_RING()'s buffer: -1, so that it won't compile, if the ring would not work.
+#if defined(__GNUC__)
+#define EZI_RING_SIZE_PRIVATE(size_pow2,flags) ( ((size_pow2) & ((size_pow2) - 1)) == 0 ? (size_pow2) : -1 )
+#else // No atomics: no EZI_RING_SPSC.
+#define EZI_RING_SIZE_PRIVATE(size_pow2,flags) \
+	( ((size_pow2) & ((size_pow2) - 1)) == 0 && !((flags) & EZI_RING_SPSC) ? (size_pow2) : -1 )
+#endif
+
+#define EZI_RING(name,size_pow2,flags) \
+	char name ## _buf[EZI_RING_SIZE_PRIVATE(size_pow2, flags)]; \
+	EZI_RING_T name ## _private = { name ## _buf, size_pow2, 0, 0, flags }; \
+	EZI_RING_T *name = &name ## _private
+
 //--------------------------------------------------------------------------------------------------
 //
 //   E Z I   S T R I N G S   :   P U B L I C   F U N C T I O N   P R O T O T Y P E S
@@ -155,6 +253,30 @@ EZI_STR(name,max_index,init_str)  Initialised ezi string. The created object is
 	EZI_STR_T      *ezi_trail       (EZI_STR_T *str);
 	EZI_STR_T      *ezi_overlay     (EZI_STR_T *str, size_t index, EZI_STR_T *from);
 	EZI_STR_T      *ezi_overlay_raw (EZI_STR_T *str, size_t index, char     *from, size_t from_len);
+	EZI_STR_T      *ezi_replace     (EZI_STR_T *to, EZI_STR_T *from, EZI_STR_T *find, EZI_STR_T *with); // First 'find' only.  'to' may be 'from'.
+	EZI_STR_T      *ezi_replace_raw (EZI_STR_T *to, EZI_STR_T *from, char     *find, char     *with);
+	EZI_STR_T      *ezi_replace_all (EZI_STR_T *to, EZI_STR_T *from, EZI_STR_T *find, EZI_STR_T *with); // Every 'find', left to right.
+	EZI_STR_T      *ezi_replace_all_raw(EZI_STR_T *to, EZI_STR_T *from, char  *find, char     *with);
+	EZI_STR_T      *ezi_upper       (EZI_STR_T *buf); // ASCII upper case, in-place.
+	EZI_STR_T      *ezi_lower       (EZI_STR_T *buf); // ASCII lower case, in-place.
+	EZI_STR_T      *ezi_translate   (EZI_STR_T *buf, unsigned char map[256]); // Replaces each byte b with map[b], in-place: SIMD for sparse maps.
+	EZI_STR_T      *ezi_tr          (EZI_STR_T *buf, char *from_set, char *to_set); // Like tr: ezi_tr(s, "a-z", "A-Z").
+
+	EZI_STR_T      *ezi_dbg         (EZI_STR_T *to, EZI_STR_T *from);  // Renders any bytes as C-escaped printable text.
+	EZI_STR_T      *ezi_dbg_raw     (EZI_STR_T *to, char     *from, size_t from_len);
+	size_t          ezi_dbg_len     (EZI_STR_T *from);  // Full length ezi_dbg() output needs.
+	EZI_STR_T      *ezi_esc         (EZI_STR_T *to, EZI_STR_T *from);  // Converts C escape sequences back to bytes. 'to' may be 'from'.
+	EZI_STR_T      *ezi_esc_raw     (EZI_STR_T *to, char     *from, size_t from_len);
+	size_t          ezi_esc_len     (EZI_STR_T *from);  // Full length ezi_esc() output needs.
+
+	// UTF-8.  Define EZI_UTF8 when building ezi_str.c to make all truncation back off to the last
+	// complete code point, instead of cutting at a byte boundary.
+	int             ezi_utf8_valid    (EZI_STR_T *buf);  // 1 if well-formed UTF-8, else 0.
+	int             ezi_utf8_valid_raw(char *string, size_t len);
+	size_t          ezi_utf8_count    (EZI_STR_T *buf);  // Number of code points.
+	size_t          ezi_utf8_count_raw(char *string, size_t len);
+	size_t          ezi_utf8_cplen    (int lead);        // Bytes in the code point started by 'lead': 1-4, or 0 if not a lead byte.
+	size_t          ezi_utf8_cut      (char string[], size_t len); // 'len', reduced to cut off an incomplete code point at the end.
 
 	EZI_STR_T      *ezi_dup_raw     (char *initstr);      // Ezi, and safe, strdup() of a raw string. Obeys strdup rules.
 	EZI_STR_T      *ezi_dup_full    (EZI_STR_T *original); // Ezi, and safe, strdup() of a full Ezi-String. Obeys strdup rules.
@@ -166,6 +288,197 @@ EZI_STR(name,max_index,init_str)  Initialised ezi string. The created object is
 	int             ezi_snprintf    (EZI_STR_T *ezi, const char *format, ... ); // Instantiated in ezi_snprintf.c
 	int             ezi_vsnprintf   (EZI_STR_T *ezi, const char *format, va_list args); // Instantiated in ezi_snprintf.c
 
+	// Head-offset Ezi strings: ezi_head_ltrim() is O(1), and the bytes are moved up lazily.
+	EZI_HEAD_T     *ezi_head_init   (EZI_HEAD_T *h, EZI_STR_T *buf);
+	size_t          ezi_head_len    (EZI_HEAD_T *h);
+	EZI_VIEW_T      ezi_head_view   (EZI_HEAD_T *h);
+	EZI_HEAD_T     *ezi_head_ltrim  (EZI_HEAD_T *h, size_t left_trim);
+	EZI_HEAD_T     *ezi_head_cat    (EZI_HEAD_T *h, EZI_STR_T *from);
+	EZI_HEAD_T     *ezi_head_cat_raw(EZI_HEAD_T *h, char *from, size_t from_len);
+	EZI_STR_T      *ezi_head_compact(EZI_HEAD_T *h); // Moves the string to the front: returns h->buf, an ordinary Ezi string again.
+
+	// Byte FIFO.  Push from the producer side only; peek, consume & pop from the consumer side only.
+	EZI_RING_T     *ezi_ring_init   (EZI_RING_T *ring, char *buf, size_t size_pow2, int flags); // NULL if size is not a power of 2, or if EZI_RING_SPSC isn't available.
+	size_t          ezi_ring_used   (EZI_RING_T *ring);
+	size_t          ezi_ring_room   (EZI_RING_T *ring);
+	size_t          ezi_ring_push   (EZI_RING_T *ring, EZI_STR_T *from);                 // Returns the number of bytes pushed.
+	size_t          ezi_ring_push_raw(EZI_RING_T *ring, char *from, size_t from_len);
+	EZI_VIEW_T      ezi_ring_peek_view(EZI_RING_T *ring);                                // Readable bytes, up to the end of the buffer.
+	void            ezi_ring_consume(EZI_RING_T *ring, size_t n);
+	size_t          ezi_ring_pop_raw(EZI_RING_T *ring, char *to, size_t max);           // Returns the number of bytes popped.
+	EZI_STR_T      *ezi_ring_pop_line(EZI_RING_T *ring, EZI_STR_T *to);                 // NULL if no whole line yet.
+
+	// Number parsers for the field buf->str[offset .. offset+len), or a view.  No '\0' needed, no
+	// locale, no spaces skipped, no allocation.  len is clamped to the string: (size_t)-1 is "to the end".
+#define             EZI_NUM_OK        0  // Returns:
+#define             EZI_NUM_EMPTY     1  // No number at the start: *value is 0.
+#define             EZI_NUM_OVERFLOW  2  // Out of range: *value is clamped to the limit.
+#define             EZI_NUM_TRAILING  3  // Number followed by other characters: *value is the number.
+	int             ezi_to_i64      (EZI_STR_T *buf, size_t offset, size_t len, int64_t  *value);
+	int             ezi_to_u64      (EZI_STR_T *buf, size_t offset, size_t len, uint64_t *value);
+	int             ezi_to_double   (EZI_STR_T *buf, size_t offset, size_t len, double   *value);
+	int             ezi_hex_to_u32  (EZI_STR_T *buf, size_t offset, size_t len, uint32_t *value); // Optional "0x".
+	int             ezi_view_to_i64    (EZI_VIEW_T view, int64_t  *value);
+	int             ezi_view_to_u64    (EZI_VIEW_T view, uint64_t *value);
+	int             ezi_view_to_double (EZI_VIEW_T view, double   *value);
+	int             ezi_view_to_hex_u32(EZI_VIEW_T view, uint32_t *value);
+
+	// Packed string table.  Views stay valid until the next add (which may move the data) or free.
+	EZI_STRTAB_T   *ezi_strtab_init (EZI_STRTAB_T *tab);
+	void            ezi_strtab_free (EZI_STRTAB_T *tab);
+	size_t          ezi_strtab_count(EZI_STRTAB_T *tab);
+	size_t          ezi_strtab_add  (EZI_STRTAB_T *tab, EZI_STR_T *from);               // Returns the index, or EZI_STRTAB_FAIL.
+	size_t          ezi_strtab_add_raw(EZI_STRTAB_T *tab, char *from, size_t from_len);
+	EZI_VIEW_T      ezi_strtab_get  (EZI_STRTAB_T *tab, size_t index);                  // {NULL,0} if no such string. '\0'-terminated.
+	EZI_STR_T      *ezi_strtab_cpy  (EZI_STR_T *to, EZI_STRTAB_T *tab, size_t index);   // Like ezi_cpy().
+	int             ezi_strtab_save (EZI_STRTAB_T *tab, char *path);                    // 0 if OK, else -1.
+	int             ezi_strtab_load (EZI_STRTAB_T *tab, char *path);                    // Maps the file: read-only. 0 if OK, else -1.
+	int             ezi_strtab_from_image(EZI_STRTAB_T *tab, void *image, size_t image_size); // Uses a saved image in memory, in place: 8-byte aligned.
+
+	// Compressed string tables: use ezi_strtab_cpy() (ezi_strtab_get() gives {NULL,0}).
+	int             ezi_strtab_compress(EZI_STRTAB_T *to, EZI_STRTAB_T *from);          // 0 if OK, else -1: out of memory, or from is compressed.
+	int             ezi_strtab_eq   (EZI_STRTAB_T *tab, size_t index, EZI_STR_T *probe);   // 1 if the same, else 0.
+	int             ezi_strtab_eq_raw(EZI_STRTAB_T *tab, size_t index, char *probe, size_t probe_len);
+	int             ezi_strtab_prefix(EZI_STRTAB_T *tab, size_t index, EZI_STR_T *prefix); // 1 if it starts with prefix, else 0.
+	int             ezi_strtab_prefix_raw(EZI_STRTAB_T *tab, size_t index, char *prefix, size_t prefix_len);
+
+	// Pool of workers for batches.  Multi-threaded only if ezi_str.c is built with EZI_THREADS.
+	// The calling thread is worker 0.  'pool' may be NULL everywhere: everything then runs on the
+	// calling thread, with a NULL scratch pointer.
+	typedef struct  ezi_pool_struct_tag EZI_POOL_T;
+	typedef void    EZI_POOL_FN     (size_t begin, size_t end, unsigned worker, void *scratch, void *context);
+	typedef void    EZI_BATCH_FN    (EZI_STR_T *buf, size_t index, void *scratch, void *context);
+	EZI_POOL_T     *ezi_pool_create (unsigned threads, size_t scratch_size); // threads 0: one per CPU. scratch_size: per worker.
+	void            ezi_pool_destroy(EZI_POOL_T *pool);
+	unsigned        ezi_pool_threads(EZI_POOL_T *pool);
+	void            ezi_pool_for    (EZI_POOL_T *pool, size_t count, size_t grain, EZI_POOL_FN *fn, void *context);
+
+	// Batches: the same operation on n Ezi strings.  to[i] gets the result for from[i].
+	void            ezi_batch_apply (EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, EZI_BATCH_FN *fn, void *context);
+	void            ezi_batch_trail (EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n);
+	void            ezi_batch_cpy   (EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STR_T *from[], size_t n);
+	void            ezi_batch_cat   (EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STR_T *from[], size_t n);
+	void            ezi_batch_strtab(EZI_POOL_T *pool, EZI_STR_T *to[], EZI_STRTAB_T *tab, EZI_BATCH_FN *fn, void *context); // to[i] gets string i, then fn (if any) is called on it.
+
+	// Sorts in memcmp() order, shorter first.  ezi_sort_unique() returns the number of unique
+	// strings, and moves the rest (duplicates) after them in buf[].
+#define             EZI_SORT_NOCASE  1  // flags: 'A'-'Z' sort as 'a'-'z'.
+	void            ezi_sort        (EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags);
+	size_t          ezi_sort_unique (EZI_POOL_T *pool, EZI_STR_T *buf[], size_t n, int flags);
+
+	// Glob patterns ('*', '?', "[a-z]", "[!...]", '\'), compiled once and matched without backtracking.
+	typedef struct  ezi_glob_struct_tag EZI_GLOB_T;
+	EZI_GLOB_T     *ezi_glob_compile(char *pattern);                        // NULL if out of memory.
+	int             ezi_glob_match  (EZI_GLOB_T *glob, EZI_STR_T *str);     // 1 if it matches, else 0.
+	int             ezi_glob_match_raw(EZI_GLOB_T *glob, char *str, size_t len);
+	void            ezi_glob_free   (EZI_GLOB_T *glob);
+
+#ifdef EZI_POSIX
+	// Deferred-format logging: ezi_log() records the arguments, a background thread (if ezi_str.c
+	// is built with EZI_THREADS) formats & writes them.  'format' must stay valid until written.
+	typedef struct  ezi_log_struct_tag EZI_LOG_T;
+#define             EZI_LOG_DROP   0  // policy: a record that doesn't fit in the ring is dropped ...
+#define             EZI_LOG_BLOCK  1  // ... or ezi_log() waits for room.
+	typedef struct
+	{
+		uint64_t recorded;          // Records taken by ezi_log() ...
+		uint64_t dropped;           // ... and lost: ring full, or out of memory.
+		uint64_t formatted;
+		uint64_t written;           // Bytes.
+		uint64_t write_errors;      // Batches not (all) written.
+		uint64_t format_ns_total;   // Time spent formatting.
+		uint64_t latency_ns_total;  // From ezi_log() to being formatted: divide by 'formatted' ...
+		uint64_t latency_ns_max;    // ... for the mean.
+	} EZI_LOG_STATS_T;
+	EZI_LOG_T      *ezi_log_create  (int fd, size_t ring_size_pow2, size_t line_max, int policy); // ring_size_pow2: per thread.
+	void            ezi_log_destroy (EZI_LOG_T *log);                                      // Writes what's left.
+	int             ezi_log         (EZI_LOG_T *log, const char *format, ... );            // 0 if recorded, -1 if dropped.
+	int             ezi_vlog        (EZI_LOG_T *log, const char *format, va_list args);
+	void            ezi_log_flush   (EZI_LOG_T *log);                                      // Waits until written.
+	void            ezi_log_stats   (EZI_LOG_T *log, EZI_LOG_STATS_T *stats);
+#endif // EZI_POSIX
+
+
+/***************************************************************************************************
+  EZI_BUILDER_T                  Appends to an Ezi string in a tight loop.  Each ezi_builder_put_xxx()
+                                 only moves a write pointer and a count of room left: the length and
+                                 the terminating '\0' are written once, by ezi_builder_finish().
+                                 Anything which doesn't fit sets 'truncated'.  The finished string is
+                                 the same as if each put had been an ezi_ch() or ezi_cat() call,
+                                 except that ezi_builder_put_str() copies all of from->len, '\0's and
+                                 all.  Don't use the Ezi string itself until finished.
+
+	EZI_BUILDER_T b;
+
+	ezi_builder_init(&b, response);
+	for ( i = 0; i < frame_len; i++ )
+		ezi_builder_put_ch(&b, decode(frame[i]));
+	ezi_builder_finish(&b);
+
+***************************************************************************************************/
+
+	typedef struct
+	{
+		EZI_STR_T *buf;
+		char      *at;         // Next byte to write.
+		size_t     room;       // Bytes left before buf->max.
+		int        truncated;  // Something didn't fit.
+	} EZI_BUILDER_T;
+
+	void            ezi_builder_ch_private (EZI_BUILDER_T *b, int ch_integer);              // Slow paths: don't call directly.
+	void            ezi_builder_mem_private(EZI_BUILDER_T *b, char *from, size_t from_len);
+
+	static inline EZI_BUILDER_T *ezi_builder_init(EZI_BUILDER_T *b, EZI_STR_T *buf) // Appends after buf's current string.
+	{
+		size_t len = ( buf->len < buf->max ) ? buf->len : buf->max;  // If too big, truncate it, as ezi_ch() does.
+
+		b->buf       = buf;
+		b->at        = &buf->str[len];
+		b->room      = buf->max - len;
+		b->truncated = 0;
+		return b;
+	}
+
+	static inline void ezi_builder_put_ch(EZI_BUILDER_T *b, int ch_integer)  // Like ezi_ch().
+	{
+		if ( (unsigned char)ch_integer < 0x80 && b->room > 0 )
+		{
+			*b->at++ = (char)ch_integer;
+			b->room--;
+		}
+		else
+			ezi_builder_ch_private(b, ch_integer);
+	}
+
+	static inline void ezi_builder_put_mem(EZI_BUILDER_T *b, char *from, size_t from_len)
+	{
+		if ( from_len <= b->room )
+		{
+			memcpy(b->at, from, from_len);
+			b->at   += from_len;
+			b->room -= from_len;
+		}
+		else
+			ezi_builder_mem_private(b, from, from_len);
+	}
+
+	static inline void ezi_builder_put_str(EZI_BUILDER_T *b, EZI_STR_T *from)  // Like ezi_cat(), but embedded '\0's are copied too.
+	{
+		ezi_builder_put_mem(b, from->str, from->len);
+	}
+
+	static inline void ezi_builder_put_raw(EZI_BUILDER_T *b, char *from)  // Like ezi_cat_raw().
+	{
+		if ( from != NULL )
+			ezi_builder_put_mem(b, from, strlen(from));
+	}
+
+	static inline EZI_STR_T *ezi_builder_finish(EZI_BUILDER_T *b)
+	{
+		b->buf->len = (size_t)(b->at - b->buf->str);
+		*b->at      = '\0';
+		return b->buf;
+	}
 
 // deprecated
 #define             ezi_set(to,from)  ezi_cpy_raw(to, from) // ezi_set() is deprecated: use ezi_cpy_raw(to, from)